@@ -7,6 +7,7 @@
 #include <raylib.h>
 
 #include <App/App.h>
+#include <App/Macro.h>
 #include <App/Widget.h>
 #include <LibCore/JSON.h>
 #include <LibCore/Logging.h>
@@ -117,24 +118,121 @@ void App::handle_keyboard(pWidget const &focus)
 {
 }
 
-void App::process_input()
+// Tasks can be posted from any thread. They run on the main thread, in the
+// order they were posted within each priority class. Threads other than the
+// main thread must not touch widgets or buffers directly, but post a task
+// that does.
+void App::post(std::function<void()> task, TaskPriority priority)
+{
+    m_mailboxes[static_cast<size_t>(priority)].post(std::move(task));
+}
+
+bool App::on_main_thread() const
+{
+    return std::this_thread::get_id() == m_main_thread;
+}
+
+// Runs posted tasks, highest priority first, until frame_budget is used up.
+// Input tasks always run, and so does at least one task per frame. What is
+// left runs in the next frame, ahead of tasks posted after it.
+void App::run_posted()
+{
+    for (size_t ix = 0; ix < TaskPriorities; ++ix) {
+        m_mailboxes[ix].drain([&ready = m_ready[ix]](Task task) {
+            ready.push_back(std::move(task));
+        });
+    }
+    auto   deadline = std::chrono::steady_clock::now() + frame_budget;
+    size_t count = 0;
+    for (size_t ix = 0; ix < TaskPriorities; ++ix) {
+        auto &ready = m_ready[ix];
+        while (!ready.empty()) {
+            if (ix != static_cast<size_t>(TaskPriority::Input) && count > 0 && std::chrono::steady_clock::now() >= deadline) {
+                trace(CMD, "Frame budget used up after {} tasks", count);
+                return;
+            }
+            auto task = std::move(ready.front());
+            ready.pop_front();
+            task();
+            ++count;
+        }
+    }
+}
+
+void App::submit_key_command(pWidget const &target, Keymap::Binding const &binding)
 {
-    {
-        auto lg = std::lock_guard(commands_mutex);
-        if (!pending_commands.empty()) {
-            auto cmd = pending_commands.front();
-            pending_commands.pop_front();
-            trace(CMD, "Executing {}({})", cmd.command.command, cmd.arguments.serialize());
-            cmd.execute(cmd.arguments);
+    if (modals.empty()) {
+        Macro::the().record_command(binding.command, binding.arguments);
+    }
+    target->submit(binding.command, binding.arguments, TaskPriority::Input);
+}
+
+static bool is_modifier_key(int key)
+{
+    return key >= KEY_LEFT_SHIFT && key <= KEY_RIGHT_SUPER;
+}
+
+// Looks the key up in the keymaps of the focused widget and its ancestors,
+// innermost first. The first command bound to it is submitted. If the key
+// starts a chord in one or more keymaps before that, the next key is looked
+// up in the keymaps for the rest of those chords instead.
+void App::dispatch_key(pWidget const &focus, KeyCombo combo)
+{
+    if (!m_chord.empty()) {
+        if (is_modifier_key(combo.key)) {
             return;
         }
+        std::vector<PendingChord> next;
+        for (auto const &[widget, keymap] : m_chord) {
+            auto binding = keymap->lookup(combo);
+            if (binding == nullptr) {
+                continue;
+            }
+            if (binding->prefix != nullptr) {
+                next.emplace_back(widget, binding->prefix.get());
+                continue;
+            }
+            if (next.empty()) {
+                submit_key_command(widget, *binding);
+            }
+            break;
+        }
+        if (next.empty()) {
+            trace(CMD, "Chord ended with {}{}", modifier_string(combo.modifier), combo.key);
+        }
+        m_chord = std::move(next);
+        return;
     }
+    focus->bubble_up([this, combo](pWidget const &w) {
+        if (auto binding = w->keymap.lookup(combo); binding != nullptr) {
+            if (binding->prefix != nullptr) {
+                m_chord.emplace_back(w, binding->prefix.get());
+                return false;
+            }
+            if (m_chord.empty()) {
+                submit_key_command(w, *binding);
+            }
+            return true;
+        }
+        return m_chord.empty() && w->process_key(combo.modifier, combo.key);
+    });
+}
+
+void App::process_input()
+{
+    run_posted();
 
     auto handle_keyboard = [this](pWidget const &f) {
         KeyboardModifier modifier = modifier_current();
         for (int ch = GetCharPressed(); ch != 0; ch = GetCharPressed()) {
+            if (!m_chord.empty()) {
+                continue;
+            }
             for (auto w = f; w != nullptr; w = w->parent) {
                 if (w->character(ch)) {
+                    if (modals.empty()) {
+                        Macro::the().record_character(ch);
+                    }
                     break;
                 }
             }
@@ -153,20 +251,7 @@ void App::process_input()
             m_pressed_keys.insert(key);
         }
         for (auto const key : keys) {
-            f->bubble_up([key, modifier](pWidget const &w) {
-                for (auto const &[name, cmd] : w->commands) {
-                    for (auto const &binding : cmd.bindings) {
-                        if (binding.key == key && binding.modifier == modifier) {
-                            JSONValue key_combo = JSONValue::object();
-                            set(key_combo, "key", key);
-                            set(key_combo, "modifier", modifier);
-                            w->submit(name, key_combo);
-                            return true;
-                        }
-                    }
-                }
-                return w->process_key(modifier, key);
-            });
+            dispatch_key(f, KeyCombo { key, modifier });
         }
     };
 
@@ -187,6 +272,7 @@ void App::process_input()
 
 void App::push_modal(pWidget const &modal)
 {
+    m_chord.clear();
     modals.push_back(modal);
 }
 
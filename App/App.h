@@ -7,10 +7,14 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
 #include <deque>
+#include <thread>
 
 #include <raylib.h>
 
+#include <App/Mailbox.h>
 #include <App/Widget.h>
 #include <LibCore/Options.h>
 
@@ -42,11 +46,11 @@ struct App : public Layout {
     bool                      quit { false };
     double                    time { 0.0 };
     std::vector<pWidget>      modals {};
-    std::mutex                commands_mutex {};
     size_t                    frame_count { 0 };
     std::vector<DrawFloating> floatings;
     std::string               title_string { "Aragorn" };
     std::string               icon_file { "aragorn.png" };
+    std::chrono::microseconds frame_budget { 4000 };
 
     App();
 
@@ -68,6 +72,8 @@ struct App : public Layout {
     void push_modal(pWidget const &modal);
     void pop_modal();
     void change_font_size(int increment);
+    void post(std::function<void()> task, TaskPriority priority = TaskPriority::Normal);
+    bool on_main_thread() const;
 
     virtual bool query_close()
     {
@@ -102,6 +108,21 @@ struct App : public Layout {
         return dynamic_pointer_cast<AppClass>(s_app);
     }
 
+    // An app without a window, to run commands on buffers without the
+    // render loop. Its widgets are not initialized.
+    template<class AppClass>
+        requires std::derived_from<AppClass, App>
+    static std::shared_ptr<AppClass> create_headless(int argc, char const **argv)
+    {
+        auto                 app_args = LibCore::parse_options(argc, argv);
+        std::shared_ptr<App> app = Widget::make<AppClass>();
+        for (auto ix = app_args; ix < argc; ++ix) {
+            app->arguments.emplace_back(argv[ix]);
+        }
+        s_app = app;
+        return dynamic_pointer_cast<AppClass>(s_app);
+    }
+
     static std::shared_ptr<App> the()
     {
         assert(s_app != nullptr);
@@ -109,8 +130,24 @@ struct App : public Layout {
     }
 
 private:
-    static std::shared_ptr<App> s_app;
-    std::set<int>               m_pressed_keys;
+    using Task = std::function<void()>;
+    static constexpr size_t TaskPriorities = static_cast<size_t>(TaskPriority::Background) + 1;
+
+    struct PendingChord {
+        pWidget       widget;
+        Keymap const *keymap;
+    };
+
+    static std::shared_ptr<App>                  s_app;
+    std::set<int>                                m_pressed_keys;
+    std::thread::id                              m_main_thread { std::this_thread::get_id() };
+    std::array<Mailbox<Task>, TaskPriorities>    m_mailboxes {};
+    std::array<std::deque<Task>, TaskPriorities> m_ready {};
+    std::vector<PendingChord>                    m_chord {};
+
+    void run_posted();
+    void dispatch_key(pWidget const &focus, KeyCombo combo);
+    void submit_key_command(pWidget const &target, Keymap::Binding const &binding);
 };
 
 }
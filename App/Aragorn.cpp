@@ -13,12 +13,15 @@
 #include <config.h>
 
 #include <App/Aragorn.h>
+#include <App/Batch.h>
 #include <App/CMode.h>
 #include <App/Editor.h>
 #include <App/LexerMode.h>
 #include <App/MiniBuffer.h>
 #include <App/Modal.h>
 #include <App/StatusBar.h>
+#include <App/WorkspaceEdit.h>
+#include <LSP/ServerPool.h>
 #include <LibCore/IO.h>
 
 namespace Aragorn {
@@ -100,6 +103,14 @@ void Aragorn::process_input()
     if (monitor != app_state.monitor()) {
         app_state.monitor(monitor);
     }
+    for (auto const &buffer : buffers) {
+        if (auto log = std::dynamic_pointer_cast<LogBuffer>(buffer); log != nullptr) {
+            log->sync();
+        }
+    }
+    CLexer::sync();
+    ServerPool::the().reap_idle();
+    WorkspaceEditor::the().poll();
     App::process_input();
 }
 
@@ -258,7 +269,10 @@ void Aragorn::initialize()
     if (res.is_error()) {
         fatal("Error reading settings: {}", res.error().to_string());
     }
-    load_font();
+    if (auto err = ServerPool::the().configure(settings); err.is_error()) {
+        fatal("Error in LSP settings: {}", err.error().to_string());
+    }
+    CLexer::register_notifications();
 
     std::string project_dir { "." };
     if (!arguments.empty()) {
@@ -276,6 +290,12 @@ void Aragorn::initialize()
         fatal("Could not open project directory '{}': {}", project_dir, project_maybe.error().to_string());
     }
     assert(project == project_maybe.value());
+
+    // Language servers need the project directory as their root. Their
+    // initialize handshake overlaps with loading the font.
+    ServerPool::the().prewarm();
+    load_font();
+
     while (!arguments.empty()) {
         auto &fname = arguments.front();
         arguments.pop_front();
@@ -284,16 +304,18 @@ void Aragorn::initialize()
             set_message(std::format("Could not open '{}': {}", fname, open_res.error().to_string()));
         }
     }
-    if (buffers.empty()) {
+    // Prewarmed language servers have created their log buffers already, so
+    // there can be buffers without any that can be edited.
+    size_t ix = 0;
+    while (ix < buffers.size() && !buffers[ix]->name.empty() && buffers[ix]->name[0] == '*')
+        ++ix;
+    if (ix == buffers.size()) {
         new_buffer();
     }
 
     auto editor_pane = Widget::make<Layout>(self(), ContainerOrientation::Horizontal);
     editor_pane->policy = SizePolicy::Stretch;
-    auto   editor = editor_pane->add_widget<Editor>();
-    size_t ix = 0;
-    while (ix < buffers.size() && !buffers[ix]->name.empty() && buffers[ix]->name[0] == '*')
-        ++ix;
+    auto editor = editor_pane->add_widget<Editor>();
     editor->select_buffer(buffers[ix]);
     editor_pane->insert_widget<Gutter>(0, editor);
     auto main_area = Widget::make<Layout>(Aragorn::the(), ContainerOrientation::Vertical);
@@ -350,12 +372,11 @@ pBuffer Aragorn::new_buffer()
     return b;
 }
 
-pBuffer Aragorn::create_system_buffer(std::string_view name)
+pLogBuffer Aragorn::create_system_buffer(std::string_view name)
 {
-    pBuffer b = Buffer::new_buffer();
+    auto b = Widget::make<LogBuffer>(Aragorn::the());
     buffers.push_back(b);
     b->name = std::format("*{}", name);
-    b->read_only = true;
     return b;
 }
 
@@ -440,6 +461,13 @@ EError Aragorn::read_settings()
         }
     }
 
+    // Time per frame spent running queued commands and background results.
+    if (auto editor = settings.get("editor"); editor && editor->is_object()) {
+        float budget_ms;
+        if (auto budget = editor->get("frame_budget_ms"); budget && !budget->convert<float>(budget_ms).is_error() && budget_ms > 0) {
+            frame_budget = std::chrono::microseconds { static_cast<long>(budget_ms * 1000) };
+        }
+    }
     return {};
 }
 
@@ -558,15 +586,57 @@ pMode Aragorn::get_mode_for_buffer(pBuffer const &buffer)
     return ret;
 }
 
+// Messages set from other threads are shown once the main thread gets to
+// them.
 void Aragorn::set_message(std::string_view const &text)
 {
+    if (!the()->on_main_thread()) {
+        the()->post([message = std::string { text }]() {
+            MiniBuffer::set_message(message);
+        });
+        return;
+    }
     MiniBuffer::set_message(text);
 }
 
+// aragorn --batch [--jobs=<n>] script.json file...
+int Aragorn::run_batch()
+{
+    if (arguments.empty()) {
+        std::println(stderr, "Usage: aragorn --batch [--jobs=<n>] <script.json> <file>...");
+        return 2;
+    }
+    if (auto res = read_settings(); res.is_error()) {
+        std::println(stderr, "Error reading settings: {}", res.error().to_string());
+        return 2;
+    }
+    auto script_file = arguments.front();
+    arguments.pop_front();
+    auto script = JSONValue::read_file(script_file);
+    if (script.is_error()) {
+        std::println(stderr, "Could not read '{}': {}", script_file, std::visit([](auto const &e) { return e.to_string(); }, script.error()));
+        return 2;
+    }
+    auto batch = Batch::decode(script.value());
+    if (batch.is_error()) {
+        std::println(stderr, "{}: {}", script_file, batch.error().to_string());
+        return 2;
+    }
+    size_t jobs = std::thread::hardware_concurrency();
+    if (auto jobs_option = get_option("jobs"); jobs_option) {
+        jobs = string_to_integer<size_t>(*jobs_option).value_or(jobs);
+    }
+    return batch.value().run({ arguments.begin(), arguments.end() }, jobs);
+}
+
 }
 
 int main(int argc, char const **argv)
 {
+    LibCore::parse_options(argc, argv);
+    if (LibCore::has_option("batch")) {
+        return Aragorn::App::create_headless<Aragorn::Aragorn>(argc, argv)->run_batch();
+    }
     auto aragorn = Aragorn::App::create<Aragorn::Aragorn>(argc, argv);
     aragorn->start();
     return 0;
@@ -15,6 +15,7 @@
 
 #include <App/App.h>
 #include <App/Buffer.h>
+#include <App/LogBuffer.h>
 #include <App/Theme.h>
 
 namespace Aragorn {
@@ -137,7 +138,7 @@ struct Aragorn : public App {
     void            process_input() override;
     void            on_terminate() override;
     pBuffer         new_buffer();
-    pBuffer         create_system_buffer(std::string_view name);
+    pLogBuffer      create_system_buffer(std::string_view name);
     Result<pBuffer> open_buffer(std::string_view const &file);
     void            close_buffer(int buffer_num);
     EError          read_settings();
@@ -147,6 +148,7 @@ struct Aragorn : public App {
     EError          open_dir(std::string_view const &dir);
     void            terminate();
     pMode           get_mode_for_buffer(pBuffer const &buffer);
+    int             run_batch();
 
     pBuffer const &buffer(int buffer_num)
     {
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <optional>
+#include <print>
+#include <thread>
+
+#include <App/Batch.h>
+#include <App/Buffer.h>
+#include <App/BufferView.h>
+#include <App/Editor.h>
+#include <LibCore/Defer.h>
+
+namespace Aragorn {
+
+static Decoded<rune_string> text_argument(JSONValue const &step, std::string const &name)
+{
+    auto text = to_wstring(TRY_EVAL(step.try_get<std::string>(name)));
+    if (text.is_error()) {
+        return JSONError { JSONError::Code::UnexpectedValue, std::format("'{}' is not valid UTF-8", name) };
+    }
+    return text.value();
+}
+
+// A view on the buffer in an editor of its own, which has no window.
+static pBufferView make_view(pBuffer const &buffer)
+{
+    return Widget::make<BufferView>(Widget::make<Editor>(nullptr), buffer);
+}
+
+// Commands hold on to the widget they belong to, so they have to go before
+// the widgets can.
+static void release_view(pBufferView const &view)
+{
+    view->commands.clear();
+    view->parent->commands.clear();
+}
+
+Decoded<Batch> Batch::decode(JSONValue const &script)
+{
+    if (!script.is_array()) {
+        return JSONError { JSONError::Code::TypeMismatch, "A batch script is an array of steps" };
+    }
+    auto  view = make_view(Widget::make<Buffer>(nullptr));
+    auto  release = [&view]() { release_view(view); };
+    Defer sg { release };
+    Batch ret;
+    for (auto const &step : script) {
+        if (step.has("text")) {
+            ret.m_steps.push_back({ .text = TRY_EVAL(text_argument(step, "text")) });
+            continue;
+        }
+        auto name = TRY_EVAL(step.try_get<std::string>("command"));
+        auto arguments = step.get("arguments").value_or(JSONValue::object());
+        if (!arguments.is_object()) {
+            return JSONError { JSONError::Code::TypeMismatch, std::format("The arguments of '{}' are not an object", name) };
+        }
+        if (to_wstring(arguments.serialize()).is_error()) {
+            return JSONError { JSONError::Code::UnexpectedValue, std::format("The arguments of '{}' are not valid UTF-8", name) };
+        }
+        Widget::WidgetCommand const *command = nullptr;
+        view->bubble_up([&name, &command](pWidget const &w) {
+            if (auto it = w->commands.find(name); it != w->commands.end()) {
+                command = &it->second;
+                return true;
+            }
+            return false;
+        });
+        if (command == nullptr || !command->headless) {
+            return JSONError { JSONError::Code::UnexpectedValue, std::format("'{}' is not a command that can run in batch mode", name) };
+        }
+        if (command->check_arguments) {
+            if (auto err = command->check_arguments(arguments); err.is_error()) {
+                return JSONError { err.error().code, std::format("'{}': {}", name, err.error().description) };
+            }
+        }
+        ret.m_steps.push_back({ .command = name, .arguments = arguments });
+    }
+    return ret;
+}
+
+Result<bool> Batch::edit_file(std::string const &path) const
+{
+    auto buffer = TRY_EVAL(Buffer::load(path));
+    auto view = make_view(buffer);
+    Macro::replay(m_steps, view);
+    release_view(view);
+    if (buffer->version == buffer->saved_version) {
+        return false;
+    }
+    TRY(buffer->write());
+    return true;
+}
+
+int Batch::run(std::vector<std::string> const &files, size_t jobs) const
+{
+    std::vector<std::optional<std::string>> errors(files.size());
+    std::vector<char>                       changed(files.size(), 0);
+    std::atomic<size_t>                     next { 0 };
+    std::vector<std::thread>                workers;
+
+    // The lines of the buffers are plain tokens, which all have this scope.
+    // Looking it up here means the workers only read the theme.
+    Theme::the().get_scope("identifier");
+    auto count = std::min(std::max<size_t>(jobs, 1), files.size());
+    for (size_t ix = 0; ix < count; ++ix) {
+        workers.emplace_back([this, &files, &errors, &changed, &next]() {
+            for (auto job = next++; job < files.size(); job = next++) {
+                if (auto res = edit_file(files[job]); res.is_error()) {
+                    errors[job] = res.error().description;
+                } else {
+                    changed[job] = res.value();
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    size_t failed = 0;
+    for (size_t ix = 0; ix < files.size(); ++ix) {
+        if (errors[ix]) {
+            std::println(stderr, "{}: {}", files[ix], *errors[ix]);
+            ++failed;
+        }
+    }
+    std::println("Edited {} of {} files, {} failed", std::ranges::count(changed, 1), files.size(), failed);
+    return (failed > 0) ? 1 : 0;
+}
+
+}
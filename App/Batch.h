@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <LibCore/JSON.h>
+#include <LibCore/Result.h>
+
+#include <App/Macro.h>
+
+namespace Aragorn {
+
+using namespace LibCore;
+
+// Runs a script of editor commands over files without a window, for
+// aragorn --batch script.json file... The script is an array of steps in the
+// shape of a recorded macro. A step either names a command and gives its
+// arguments, or is text to type:
+//
+//   [ { "command": "editor-find-replace", "arguments": { "find": "foo", "replace": "bar" } },
+//     { "command": "cursor-bottom" },
+//     { "text": "// end\n" },
+//     { "command": "editor-trim-trailing-whitespace" } ]
+//
+// Only commands registered as headless can be used. The whole script is
+// checked before any file is touched, including the arguments of commands
+// that would otherwise ask for them, like the "find" of editor-find. The files are divided over a pool of
+// worker threads. Each file is loaded into a buffer of its own, the steps
+// are replayed in a view on it, and it is saved if it changed.
+class Batch {
+public:
+    static Decoded<Batch> decode(JSONValue const &script);
+    int                   run(std::vector<std::string> const &files, size_t jobs) const;
+
+private:
+    Result<bool> edit_file(std::string const &path) const;
+
+    std::vector<MacroStep> m_steps {};
+};
+
+}
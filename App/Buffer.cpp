@@ -6,6 +6,7 @@
 
 #include <cctype>
 #include <codecvt>
+#include <limits>
 #include <print>
 
 #include <LibCore/Defer.h>
@@ -16,15 +17,12 @@
 #include <App/Buffer.h>
 #include <App/LexerMode.h>
 #include <LSP/LSP.h>
-#include <LSP/Schema/SemanticTokens.h>
 
 namespace Aragorn {
 
 using namespace LibCore;
 using namespace std::literals::string_literals;
 
-void semantic_tokens_response(pWidget const &widget, JSONValue const &resp);
-
 Buffer::Buffer(pWidget const &parent)
     : Widget(parent)
 {
@@ -32,9 +30,6 @@ Buffer::Buffer(pWidget const &parent)
 
 void Buffer::initialize()
 {
-    add_command<Buffer>(
-        "lsp-textDocument/semanticTokens/full",
-        semantic_tokens_response);
 }
 
 Result<pBuffer> Buffer::open(std::string_view const &name)
@@ -45,18 +40,35 @@ Result<pBuffer> Buffer::open(std::string_view const &name)
     if (auto listener = buffer->m_mode->event_listener(); listener) {
         buffer->add_listener(listener);
     }
-    auto contents = TRY_EVAL(read_file_by_name<rune>(name));
-    auto cap = static_cast<size_t>(static_cast<float>(contents.length()) * 1.2);
-    buffer->text_size = contents.length();
-    buffer->end_gap = cap - buffer->text_size;
-    buffer->m_text.resize(cap, 0);
-    auto i = buffer->it(buffer->end_gap);
-    std::ranges::copy(contents, i);
+    TRY(buffer->read(name));
     buffer->apply(BufferEvent::make_open());
     buffer->lex();
     return buffer;
 }
 
+// For editing without a window. The buffer has no mode and stays in a batch
+// until it is dropped, so its lines are plain tokens and the lexer never
+// runs. Buffers loaded this way can be edited on different threads.
+Result<pBuffer> Buffer::load(std::string_view const &name)
+{
+    auto buffer = Widget::make<Buffer>(nullptr);
+    buffer->name = name;
+    TRY(buffer->read(name));
+    buffer->begin_batch();
+    return buffer;
+}
+
+CError Buffer::read(std::string_view const &file_name)
+{
+    auto contents = TRY_EVAL(read_file_by_name<rune>(file_name));
+    auto cap = static_cast<size_t>(static_cast<float>(contents.length()) * 1.2);
+    text_size = contents.length();
+    end_gap = cap - text_size;
+    m_text.resize(cap, 0);
+    std::ranges::copy(contents, it(end_gap));
+    return {};
+}
+
 pBuffer Buffer::new_buffer()
 {
     auto buffer = Widget::make<Buffer>(Aragorn::the());
@@ -240,7 +252,8 @@ void Buffer::ensure_capacity(size_t num)
 {
     auto new_cap = (m_text.size() > 0) ? m_text.size() : 1.2 * num;
     while (text_size + num > static_cast<int>(static_cast<float>(new_cap) * 0.9)) {
-        new_cap = static_cast<int>(static_cast<float>(new_cap) * 1.2);
+        // Adding one makes small capacities, which a fifth doesn't change, grow.
+        new_cap = static_cast<int>(static_cast<float>(new_cap) * 1.2) + 1;
     }
     if (new_cap > m_text.size()) {
         auto old_cap = m_text.size();
@@ -261,7 +274,6 @@ void Buffer::insert_string(size_t pos, rune_view s)
         insert_rune(pos + ix, s[ix]);
     }
     ++version;
-    lex();
 }
 
 void Buffer::append_string(rune_view s)
@@ -274,7 +286,6 @@ void Buffer::append_string(rune_view s)
         insert_rune(text_size, r);
     }
     ++version;
-    lex();
 }
 
 void Buffer::erase(size_t pos, size_t len)
@@ -288,12 +299,16 @@ void Buffer::erase(size_t pos, size_t len)
     }
     set(pos);
     end_gap += len;
+    text_size -= len;
     ++version;
-    lex();
 }
 
+// The lexer peeks one past the end of the text.
 rune Buffer::at(size_t pos) const
 {
+    if (pos >= text_size) {
+        return 0;
+    }
     return (pos < cursor) ? m_text[pos] : m_text[end_gap + (pos - cursor)];
 }
 
@@ -307,7 +322,7 @@ rune_string Buffer::substr(size_t pos, size_t len)
     if (pos < cursor) {
         ret = rune_string { m_text.data() + pos, std::min(len, cursor - pos) };
         if (pos + len > cursor) {
-            ret += rune_string { m_text.data() + end_gap, len - cursor };
+            ret += rune_string { m_text.data() + end_gap, pos + len - cursor };
         }
     } else {
         ret = rune_string { m_text.data() + end_gap + (pos - cursor), len };
@@ -315,8 +330,56 @@ rune_string Buffer::substr(size_t pos, size_t len)
     return ret;
 }
 
+// The text an edit removes and the text it inserts.
+static std::pair<rune_view, rune_view> changed_text(BufferEvent const &event)
+{
+    switch (event.type) {
+    case BufferEventType::Insert:
+        return { rune_view {}, event.insert() };
+    case BufferEventType::Delete:
+        return { event.deletion(), rune_view {} };
+    case BufferEventType::Replace:
+        // apply() ignores a replacement with nothing.
+        if (event.replacement().replacement.empty()) {
+            return {};
+        }
+        return { event.replacement().overwritten, event.replacement().replacement };
+    default:
+        return {};
+    }
+}
+
+// Moves the diagnostics and semantic tokens after an edit along with the
+// text. Called before the edit is applied, while lines still describes the
+// text the event's position refers to.
+void Buffer::shift_overlays(BufferEvent const &event)
+{
+    if ((diagnostics.empty() && semantic_overlay.empty()) || lines.empty()) {
+        return;
+    }
+    auto [removed, inserted] = changed_text(event);
+    if (removed.empty() && inserted.empty()) {
+        return;
+    }
+    auto        line = line_for_index(event.position);
+    Vec<size_t> start { .column = event.position - lines[line].begin(), .line = line };
+    auto        end_of = [&start](rune_view const &text) -> Vec<size_t> {
+        auto newlines = static_cast<size_t>(std::ranges::count(text, L'\n'));
+        if (newlines == 0) {
+            return { .column = start.column + text.length(), .line = start.line };
+        }
+        return { .column = text.length() - text.rfind(L'\n') - 1, .line = start.line + newlines };
+    };
+    auto old_end = end_of(removed);
+    auto new_end = end_of(inserted);
+    diagnostics.edit(start, old_end, new_end);
+    semantic_overlay.edit(start, old_end, new_end);
+}
+
 void Buffer::apply(BufferEvent const &event)
 {
+    shift_overlays(event);
+    auto line = batching() ? line_for_index(event.position) : 0;
     switch (event.type) {
     case BufferEventType::Insert: {
         auto const &s = event.insert();
@@ -357,9 +420,7 @@ void Buffer::apply(BufferEvent const &event)
         if (name.empty() || saved_version == version) {
             return;
         }
-        set(text_size);
-        MUST(write_file_by_name(name, rune_view { m_text.data(), text_size }));
-        saved_version = version;
+        MUST(write());
     } break;
     case BufferEventType::Close: {
         for (auto &listener : listeners) {
@@ -374,16 +435,157 @@ void Buffer::apply(BufferEvent const &event)
         indexed_version = 0;
         name.clear();
         m_uri.clear();
+        semantic_tokens_result_id.clear();
+        semantic_tokens.clear();
+        semantic_overlay.clear();
+        diagnostics = {};
         return;
     }
     default:
         break;
     }
+    if (batching() && event.type != BufferEventType::Save) {
+        // Listeners hear about the edits in a batch when it ends.
+        reindex_batch(event, line);
+        return;
+    }
+    if (!batching()) {
+        lex();
+    }
     for (auto &listener : listeners) {
         listener(std::dynamic_pointer_cast<Buffer>(self()), event);
     }
 }
 
+// Edits made between begin_batch() and end_batch() become one undo step and
+// one change for the listeners, and the lexer runs once, at the end. Until
+// then, lines holds plain tokens, kept up to date edit by edit.
+void Buffer::begin_batch()
+{
+    assert(!batching());
+    set(text_size);
+    m_batch_text = rune_string { m_text.data(), text_size };
+    m_batch_undo = undo_pointer;
+    lines.clear();
+    split_lines(0, 0, std::numeric_limits<size_t>::max(), lines);
+}
+
+// The batch's edits are replaced by a single event changing the text between
+// the first and the last difference with the text at the start of the batch.
+void Buffer::end_batch()
+{
+    assert(batching());
+    auto before = std::move(*m_batch_text);
+    m_batch_text.reset();
+    set(text_size);
+    rune_view after { m_text.data(), text_size };
+    size_t    prefix = 0;
+    while (prefix < before.length() && prefix < after.length() && before[prefix] == after[prefix]) {
+        ++prefix;
+    }
+    size_t suffix = 0;
+    while (suffix < before.length() - prefix && suffix < after.length() - prefix
+        && before[before.length() - suffix - 1] == after[after.length() - suffix - 1]) {
+        ++suffix;
+    }
+    lines.clear();
+    lex();
+    if (m_batch_undo < undo_stack.size()) {
+        undo_stack.erase(undo_stack.begin() + static_cast<ptrdiff_t>(m_batch_undo), undo_stack.end());
+    }
+    undo_pointer = undo_stack.size();
+    if (prefix + suffix == before.length() && prefix + suffix == after.length()) {
+        return;
+    }
+
+    auto position_of = [&before](size_t index) -> Vec<size_t> {
+        auto head = rune_view { before }.substr(0, index);
+        auto newline = head.rfind(L'\n');
+        auto column = (newline == rune_view::npos) ? index : index - newline - 1;
+        return { .column = column, .line = static_cast<size_t>(std::ranges::count(head, L'\n')) };
+    };
+    EventRange range { position_of(prefix), position_of(before.length() - suffix) };
+    auto       overwritten = before.substr(prefix, before.length() - suffix - prefix);
+    auto       replacement = rune_string { after.substr(prefix, after.length() - suffix - prefix) };
+    auto       event = overwritten.empty()
+              ? BufferEvent::make_insert(range, prefix, std::move(replacement))
+              : replacement.empty()
+              ? BufferEvent::make_delete(range, prefix, std::move(overwritten))
+              : BufferEvent::make_replacement(range, prefix, std::move(overwritten), std::move(replacement));
+    undo_stack.push_back(event);
+    undo_pointer = undo_stack.size();
+    for (auto &listener : listeners) {
+        listener(std::dynamic_pointer_cast<Buffer>(self()), event);
+    }
+}
+
+// Splits the text from index into lines of plain tokens, without running
+// the lexer. Stops after count lines or at the end of the text.
+void Buffer::split_lines(size_t index, size_t lineno, size_t count, std::vector<Line> &out) const
+{
+    static constexpr size_t tab_size = 4;
+
+    auto   scope = Theme::the().get_scope("identifier");
+    auto  *line = &out.emplace_back();
+    size_t column = 0;
+    auto   ix = index;
+    while (ix < text_size) {
+        auto r = at(ix);
+        if (r == '\n') {
+            line->tokens.emplace_back(ix, 1, lineno, column, TokenKind::EndOfLine, scope);
+            if (--count == 0) {
+                return;
+            }
+            line = &out.emplace_back();
+            ++lineno;
+            column = 0;
+            ++ix;
+            continue;
+        }
+        if (r == '\t') {
+            line->tokens.emplace_back(ix, 1, lineno, column, TokenKind::Tab, scope);
+            column = ((column / tab_size) + 1) * tab_size;
+            ++ix;
+            continue;
+        }
+        auto end = ix;
+        while (end < text_size && at(end) != '\n' && at(end) != '\t') {
+            ++end;
+        }
+        line->tokens.emplace_back(ix, end - ix, lineno, column, TokenKind::Identifier, scope);
+        column += end - ix;
+        ix = end;
+    }
+    line->tokens.emplace_back(text_size, 0, lineno, column, TokenKind::EndOfFile, scope);
+}
+
+// Called after an edit in a batch has been applied, with the line the edit
+// started on. The lines the edit touched are split again, and the tokens of
+// the lines after them are moved along with the text.
+void Buffer::reindex_batch(BufferEvent const &event, size_t line)
+{
+    auto [removed, inserted] = changed_text(event);
+    if (lines.empty() || line >= lines.size()) {
+        lines.clear();
+        split_lines(0, 0, std::numeric_limits<size_t>::max(), lines);
+        return;
+    }
+    auto              old_count = std::min(static_cast<size_t>(std::ranges::count(removed, L'\n')) + 1, lines.size() - line);
+    auto              new_count = static_cast<size_t>(std::ranges::count(inserted, L'\n')) + 1;
+    std::vector<Line> edited;
+    split_lines(lines[line].begin(), line, new_count, edited);
+    auto index_shift = static_cast<ptrdiff_t>(inserted.length()) - static_cast<ptrdiff_t>(removed.length());
+    auto line_shift = static_cast<ptrdiff_t>(edited.size()) - static_cast<ptrdiff_t>(old_count);
+    for (auto ix = line + old_count; ix < lines.size(); ++ix) {
+        for (auto &token : lines[ix].tokens) {
+            token.shift(index_shift, line_shift);
+        }
+    }
+    auto first = lines.begin() + static_cast<ptrdiff_t>(line);
+    first = lines.erase(first, first + static_cast<ptrdiff_t>(old_count));
+    lines.insert(first, std::make_move_iterator(edited.begin()), std::make_move_iterator(edited.end()));
+}
+
 void Buffer::edit(BufferEvent const &event)
 {
     apply(event);
@@ -457,6 +659,67 @@ void Buffer::replace(size_t pos, size_t num, rune_string replacement)
     edit(BufferEvent::make_replacement(range, pos, overwritten, replacement));
 }
 
+// Positions are resolved against the lines before anything changes, so the
+// edits' indices stay valid.
+CError Buffer::apply_text_edits(std::vector<LSP::TextEdit> const &edits)
+{
+    auto index_of = [this](LSP::Position const &pos) -> size_t {
+        if (pos.line >= lines.size()) {
+            return text_size;
+        }
+        auto const &line = lines[pos.line];
+        return std::min(line.begin() + pos.character, line.end());
+    };
+    std::vector<RangeEdit> resolved;
+    resolved.reserve(edits.size());
+    for (auto const &edit : edits) {
+        auto start = index_of(edit.range.start);
+        auto end = std::max(start, index_of(edit.range.end));
+        resolved.emplace_back(start, end, TRY_EVAL(to_wstring(edit.newText)));
+    }
+    return apply_edits(std::move(resolved));
+}
+
+// The edits are merged into a single replacement of the text from the start
+// of the first edit to the end of the last one. That makes them one undo
+// step, one re-lex and one document change for the language server, no
+// matter how many edits there are.
+CError Buffer::apply_edits(std::vector<RangeEdit> edits)
+{
+    if (edits.empty()) {
+        return {};
+    }
+    // Edits starting at the same position are applied in the order given.
+    std::ranges::stable_sort(edits, {}, &RangeEdit::start);
+    for (size_t ix = 1; ix < edits.size(); ++ix) {
+        if (edits[ix].start < edits[ix - 1].end) {
+            return LibCError("Overlapping text edits at offset {}", edits[ix].start);
+        }
+    }
+
+    auto        first = edits.front().start;
+    auto        last = edits.back().end;
+    auto        overwritten = (last > first) ? substr(first, last - first) : rune_string {};
+    rune_string replacement;
+    auto        at = first;
+    for (auto const &edit : edits) {
+        replacement.append(overwritten, at - first, edit.start - at);
+        replacement += edit.text;
+        at = edit.end;
+    }
+    if (replacement == overwritten) {
+        return {};
+    }
+    if (overwritten.empty()) {
+        insert(first, std::move(replacement));
+    } else if (replacement.empty()) {
+        del(first, last - first);
+    } else {
+        replace(first, last - first, std::move(replacement));
+    }
+    return {};
+}
+
 void Buffer::merge_lines(size_t top_line)
 {
     if (top_line > lines.size() - 1) {
@@ -485,6 +748,16 @@ void Buffer::save_as(std::string_view const &new_name)
     apply(BufferEvent::make_save_as(new_name));
 }
 
+// Writes the text to the buffer's file without going through a save event,
+// so a failure is returned to the caller instead of aborting.
+CError Buffer::write()
+{
+    set(text_size);
+    TRY(write_file_by_name(name, rune_view { m_text.data(), text_size }));
+    saved_version = version;
+    return {};
+}
+
 size_t Buffer::word_boundary_left(size_t index) const
 {
     index = clamp(index, 0, text_size - 1);
@@ -531,53 +804,9 @@ std::string const &Buffer::uri()
     return m_uri;
 }
 
-void semantic_tokens_response(pWidget const &widget, JSONValue const &resp)
+void Buffer::apply_semantic_tokens(std::vector<uint32_t> const &data)
 {
-    auto buffer = std::dynamic_pointer_cast<Buffer>(widget);
-    auto response = Response::decode(resp);
-    if (!response.has_value()) {
-        std::println("Error decoding LSP response: {}", response.error().description);
-        return;
-    }
-    if (!response.value().result.has_value()) {
-        std::println("No response to textDocument/semanticTokens/full");
-        return;
-    }
-    auto result_maybe = SemanticTokens::decode(response.value().result.value());
-    if (!result_maybe.has_value()) {
-        std::println("Couldn't decode response to textDocument/semanticTokens/full: {}", result_maybe.error().description);
-        return;
-    }
-    auto        result = result_maybe.value();
-    size_t      lineno { 0 };
-    size_t      offset { 0 };
-    auto const &data = result.data;
-    size_t      token_ix { 0 };
-    for (size_t ix = 0; ix < data.size(); ix += 5) {
-        if (data[ix] > 0) {
-            lineno += data[ix];
-            if (lineno >= buffer->lines.size()) {
-                break;
-            }
-            offset = 0;
-            token_ix = 0;
-        }
-        offset += data[ix + 1];
-        // std::println("Semantic token[{}] = (Δline {}, Δcol {}, length {} type {} {}) line {} col {}", ix, data[ix], data[ix + 1], data[ix + 2], data[ix + 3], data[ix + 4], lineno, offset);
-        size_t length { data[ix + 2] };
-        for (; token_ix < buffer->lines[lineno].tokens.size(); ++token_ix) {
-            auto &t = buffer->lines[lineno].tokens[token_ix];
-            // std::println("t.column: {} t.length: {}", t.column(), t.length());
-            if (t.column() == offset && t.length() == length) {
-                t.get_scope(static_cast<SemanticTokenTypes>(data[ix + 3]));
-                break;
-            }
-        }
-        if (token_ix >= buffer->lines[lineno].tokens.size()) {
-            std::println("SemanticTokens OUT OF SYNC");
-            break;
-        }
-    }
+    semantic_overlay.set(data);
 }
 
 }
@@ -6,12 +6,17 @@
 
 #pragma once
 
+#include <atomic>
+
 #include <LibCore/Result.h>
 
+#include <App/DiagnosticIndex.h>
 #include <App/Event.h>
 #include <App/Mode.h>
+#include <App/SemanticOverlay.h>
 #include <App/Theme.h>
 #include <App/Widget.h>
+#include <LSP/Schema/TextEdit.h>
 
 namespace Aragorn {
 
@@ -50,6 +55,13 @@ struct Line {
     }
 };
 
+// Replaces the text from start up to end with text.
+struct RangeEdit {
+    size_t      start;
+    size_t      end;
+    rune_string text;
+};
+
 using pBuffer = std::shared_ptr<Buffer>;
 
 struct Buffer : public Widget {
@@ -63,13 +75,21 @@ struct Buffer : public Widget {
     size_t                           text_size { 0 };
     size_t                           saved_version { 0 };
     size_t                           indexed_version { 0 };
-    size_t                           version { 0 };
+    // Only changed on the main thread, but read by the LSP reader thread to
+    // drop responses for an older version.
+    std::atomic<size_t>              version { 0 };
     size_t                           undo_pointer { 0 };
     pMode const                     &mode() { return m_mode; }
     std::vector<BufferEventListener> listeners {};
+    std::string                      semantic_tokens_result_id {};
+    std::vector<uint32_t>            semantic_tokens {};
+    SemanticOverlay                  semantic_overlay {};
+    std::pair<size_t, size_t>        visible_lines { 0, 0 };
+    DiagnosticIndex                  diagnostics {};
 
     explicit Buffer(pWidget const &parent);
     static Result<pBuffer, LibCError> open(std::string_view const &name);
+    static Result<pBuffer, LibCError> load(std::string_view const &name);
     static pBuffer                    new_buffer();
     void                              initialize() override;
     void                              close();
@@ -82,6 +102,11 @@ struct Buffer : public Widget {
     void                              insert(size_t pos, std::string_view text);
     void                              del(size_t pos, size_t count);
     void                              replace(size_t pos, size_t num, rune_string replacement);
+    CError                            apply_text_edits(std::vector<LSP::TextEdit> const &edits);
+    CError                            apply_edits(std::vector<RangeEdit> edits);
+    void                              begin_batch();
+    void                              end_batch();
+    [[nodiscard]] bool                batching() const { return m_batch_text.has_value(); }
     size_t                            line_for_index(size_t index, std::optional<Vec<size_t>> const &hint = {}) const;
     Vec<size_t>                       index_to_position(size_t index, std::optional<Vec<size_t>> const &hint = {}) const;
     size_t                            position_to_index(Vec<size_t> position) const;
@@ -89,9 +114,11 @@ struct Buffer : public Widget {
     size_t                            find(rune_view needle, size_t offset = 0);
     void                              save();
     void                              save_as(std::string_view const &new_name);
+    CError                            write();
     size_t                            word_boundary_left(size_t index) const;
     size_t                            word_boundary_right(size_t index) const;
     void                              add_listener(BufferEventListener const &listener);
+    void                              apply_semantic_tokens(std::vector<uint32_t> const &data);
     std::string const                &uri();
 
     size_t length() const
@@ -122,18 +149,24 @@ struct Buffer : public Widget {
     [[nodiscard]] rune at(size_t pos) const;
     rune_string        substr(size_t pos, size_t len = rune_view::npos);
 
-private:
-    std::vector<rune> m_text {};
-    std::string       m_uri {};
-    pMode             m_mode;
-    bool              m_locked { false };
-
-    void set(size_t pos);
-    void insert_rune(size_t pos, rune r);
-    void ensure_capacity(size_t num);
-    void insert_string(size_t pos, rune_view s);
-    void append_string(rune_view s);
-    void erase(size_t pos, size_t len = rune_view::npos);
+protected:
+    std::vector<rune>          m_text {};
+    std::string                m_uri {};
+    pMode                      m_mode;
+    bool                       m_locked { false };
+    std::optional<rune_string> m_batch_text {};
+    size_t                     m_batch_undo { 0 };
+
+    CError read(std::string_view const &file_name);
+    void   set(size_t pos);
+    void   split_lines(size_t index, size_t lineno, size_t count, std::vector<Line> &out) const;
+    void   reindex_batch(BufferEvent const &event, size_t line);
+    void   shift_overlays(BufferEvent const &event);
+    void   insert_rune(size_t pos, rune r);
+    void   ensure_capacity(size_t num);
+    void   insert_string(size_t pos, rune_view s);
+    void   append_string(rune_view s);
+    void   erase(size_t pos, size_t len = rune_view::npos);
 
     auto it(size_t pos = 0)
     {
@@ -7,8 +7,10 @@
 #include <App/Aragorn.h>
 #include <App/BufferView.h>
 #include <App/Editor.h>
+#include <App/Macro.h>
 #include <App/MiniBuffer.h>
 #include <App/Modal.h>
+#include <App/WorkspaceEdit.h>
 
 namespace Aragorn {
 
@@ -34,7 +36,12 @@ bool do_select(JSONValue const &key_combo)
 
 void cmd_up(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_up(do_select(key_combo));
+    if (view->completing() && !do_select(key_combo)) {
+        view->select_completion(-1);
+        return;
+    }
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_up(select); });
 }
 
 void cmd_select_word(pBufferView const &view, JSONValue const &)
@@ -44,32 +51,42 @@ void cmd_select_word(pBufferView const &view, JSONValue const &)
 
 void cmd_down(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_down(do_select(key_combo));
+    if (view->completing() && !do_select(key_combo)) {
+        view->select_completion(1);
+        return;
+    }
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_down(select); });
 }
 
 void cmd_left(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_left(do_select(key_combo));
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_left(select); });
 }
 
 void cmd_word_left(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_word_left(do_select(key_combo));
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_word_left(select); });
 }
 
 void cmd_right(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_right(do_select(key_combo));
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_right(select); });
 }
 
 void cmd_word_right(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_word_right(do_select(key_combo));
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_word_right(select); });
 }
 
 void cmd_begin_of_line(pBufferView const &view, JSONValue const &key_combo)
 {
-    view->move_begin_of_line(do_select(key_combo));
+    auto select = do_select(key_combo);
+    view->move_carets([&view, select]() { view->move_begin_of_line(select); });
 }
 
 void cmd_top_of_buffer(pBufferView const &view, JSONValue const &key_combo)
@@ -99,14 +116,86 @@ void cmd_page_down(pBufferView const &view, JSONValue const &key_combo)
 
 void cmd_split_line(pBufferView const &view, JSONValue const &)
 {
+    if (view->accept_completion()) {
+        return;
+    }
     view->character('\n');
 }
 
 void cmd_insert_tab(pBufferView const &view, JSONValue const &)
 {
+    if (view->accept_completion()) {
+        return;
+    }
     view->character('\t');
 }
 
+void cmd_complete(pBufferView const &view, JSONValue const &)
+{
+    view->complete();
+}
+
+void do_rename(pBufferView const &view, rune_string const &new_name)
+{
+    if (new_name.empty()) {
+        return;
+    }
+    view->buffer()->mode()->rename(view->index(), MUST_EVAL(to_utf8(new_name)));
+}
+
+void cmd_rename(pBufferView const &view, JSONValue const &)
+{
+    if (view->buffer()->read_only || view->buffer()->mode() == nullptr) {
+        return;
+    }
+    MiniBuffer::query(view, L"Rename to", do_rename);
+}
+
+void cmd_undo_workspace_edit(pBufferView const &, JSONValue const &)
+{
+    WorkspaceEditor::the().undo();
+}
+
+void cmd_format(pBufferView const &view, JSONValue const &)
+{
+    if (view->buffer()->read_only || view->buffer()->mode() == nullptr) {
+        return;
+    }
+    view->buffer()->mode()->format();
+}
+
+void cmd_trim_trailing_whitespace(pBufferView const &view, JSONValue const &)
+{
+    auto const &buffer = view->buffer();
+    if (buffer->read_only) {
+        return;
+    }
+    std::vector<RangeEdit> edits;
+    for (auto const &line : buffer->lines) {
+        auto end = line.tokens.back().index();
+        auto start = end;
+        while (start > line.begin() && (buffer->at(start - 1) == ' ' || buffer->at(start - 1) == '\t')) {
+            --start;
+        }
+        if (start < end) {
+            edits.emplace_back(start, end, rune_string {});
+        }
+    }
+    if (auto err = buffer->apply_edits(std::move(edits)); err.is_error()) {
+        Aragorn::set_message(err.error().description);
+    }
+    view->move_cursor(BufferView::CursorMovement::by_index(std::min(view->index(), buffer->length())));
+}
+
+void cmd_insert_final_newline(pBufferView const &view, JSONValue const &)
+{
+    auto const &buffer = view->buffer();
+    if (buffer->read_only || buffer->empty() || buffer->at(buffer->length() - 1) == '\n') {
+        return;
+    }
+    buffer->insert(buffer->length(), rune_string { L"\n" });
+}
+
 void cmd_merge_lines(pBufferView const &view, JSONValue const &)
 {
     auto const &buffer = view->buffer();
@@ -203,9 +292,37 @@ void cmd_delete_current_char(pBufferView const &view, JSONValue const &)
 
 void cmd_clear_selection(pBufferView const &view, JSONValue const &)
 {
+    view->cancel_completion();
+    view->clear_carets();
     view->clear_selection();
 }
 
+void cmd_add_caret_above(pBufferView const &view, JSONValue const &)
+{
+    view->add_caret_above();
+}
+
+void cmd_add_caret_below(pBufferView const &view, JSONValue const &)
+{
+    view->add_caret_below();
+}
+
+void cmd_add_caret_at_next_match(pBufferView const &view, JSONValue const &)
+{
+    if (!view->add_caret_at_next_match()) {
+        Aragorn::set_message("No more matches");
+    }
+}
+
+void cmd_split_selection_into_lines(pBufferView const &view, JSONValue const &)
+{
+    if (!view->has_selection()) {
+        Aragorn::set_message("No region selected");
+        return;
+    }
+    view->split_selection_into_lines();
+}
+
 void cmd_copy(pBufferView const &view, JSONValue const &)
 {
     view->copy();
@@ -231,13 +348,50 @@ void cmd_redo(pBufferView const &view, JSONValue const &)
     view->buffer()->redo();
 }
 
+// Commands that prompt for text take it from their arguments instead if it
+// is there, as it is when they are run by a batch script.
+static std::optional<rune_string> text_argument(JSONValue const &args, std::string_view const &name)
+{
+    auto text = args.try_get<std::string>(name);
+    if (text.is_error()) {
+        return {};
+    }
+    auto ret = to_wstring(text.value());
+    if (ret.is_error() || ret.value().empty()) {
+        return {};
+    }
+    return ret.value();
+}
+
+// Without a minibuffer to ask, the text to find has to be in the arguments.
+static JSONValue::EJSON check_find_arguments(JSONValue const &args)
+{
+    if (!text_argument(args, "find")) {
+        return JSONError { JSONError::Code::MissingValue, "'find' must be non-empty text" };
+    }
+    return {};
+}
+
+static JSONValue::EJSON check_find_replace_arguments(JSONValue const &args)
+{
+    TRY(check_find_arguments(args));
+    if (args.try_get<std::string>("replace").is_error()) {
+        return JSONError { JSONError::Code::MissingValue, "'replace' must be text" };
+    }
+    return {};
+}
+
 void do_find(pBufferView const &view, rune_string const &query)
 {
     view->find_first(query);
 }
 
-void cmd_find(pBufferView const &view, JSONValue const &)
+void cmd_find(pBufferView const &view, JSONValue const &args)
 {
+    if (auto find = text_argument(args, "find"); find) {
+        do_find(view, *find);
+        return;
+    }
     MiniBuffer::query(view, L"Find", do_find);
 }
 
@@ -292,11 +446,30 @@ void do_find_query(pBufferView const &view, rune_string const &query)
     MiniBuffer::query(view, L"Replace with", do_replacement_query);
 }
 
-void cmd_find_replace(pBufferView const &view, JSONValue const &)
+// Replaces every match in the buffer without asking, in one edit.
+static void replace_all(pBufferView const &view, rune_string const &find, rune_string const &replacement)
+{
+    auto const            &buffer = view->buffer();
+    auto                   text = buffer->substr(0);
+    std::vector<RangeEdit> edits;
+    for (auto at = text.find(find); at != rune_string::npos; at = text.find(find, at + find.length())) {
+        edits.emplace_back(at, at + find.length(), replacement);
+    }
+    if (auto err = buffer->apply_edits(std::move(edits)); err.is_error()) {
+        Aragorn::set_message(err.error().description);
+    }
+    view->move_cursor(BufferView::CursorMovement::by_index(std::min(view->index(), buffer->length())));
+}
+
+void cmd_find_replace(pBufferView const &view, JSONValue const &args)
 {
     if (view->buffer()->read_only) {
         return;
     }
+    if (auto find = text_argument(args, "find"); find && args.has("replace")) {
+        replace_all(view, *find, text_argument(args, "replace").value_or(rune_string {}));
+        return;
+    }
     MiniBuffer::query(view, L"Find", do_find_query);
 }
 
@@ -359,6 +532,102 @@ void cmd_save(pBufferView const &view, JSONValue const &dummy)
     Aragorn::set_message("Buffer saved");
 }
 
+void cmd_macro_start(pBufferView const &, JSONValue const &)
+{
+    Macro::the().start();
+    Aragorn::set_message("Recording macro");
+}
+
+void cmd_macro_stop(pBufferView const &, JSONValue const &)
+{
+    if (!Macro::the().recording()) {
+        Aragorn::set_message("Not recording a macro");
+        return;
+    }
+    Macro::the().stop();
+    Aragorn::set_message(std::format("Recorded macro of {} steps", Macro::the().steps().size()));
+}
+
+// The replays are one batch of edits to the view's buffer: one undo step,
+// one change sent to the language server and one re-lex, at the end.
+template<typename Fn>
+static void replay_macro(pBufferView const &view, Fn const &replay)
+{
+    if (Macro::the().steps().empty()) {
+        Aragorn::set_message("No macro recorded");
+        return;
+    }
+    auto buffer = view->buffer();
+    auto start = std::chrono::steady_clock::now();
+    buffer->begin_batch();
+    auto count = replay(buffer);
+    buffer->end_batch();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    Aragorn::set_message(std::format("Replayed macro {} times in {} ms", count, elapsed.count()));
+}
+
+void cmd_macro_replay(pBufferView const &view, JSONValue const &args)
+{
+    if (Macro::the().recording()) {
+        cmd_macro_stop(view, args);
+        return;
+    }
+    replay_macro(view, [&view](pBuffer const &) -> size_t {
+        Macro::the().replay(view);
+        return 1;
+    });
+}
+
+void do_macro_replay_times(pBufferView const &view, rune_string const &query)
+{
+    auto times = string_to_integer<int>(MUST_EVAL(to_utf8(query)));
+    if (!times.has_value() || times.value() < 1) {
+        Aragorn::set_message("Not a number of times");
+        return;
+    }
+    replay_macro(view, [&view, &times](pBuffer const &) -> size_t {
+        for (auto ix = 0; ix < times.value(); ++ix) {
+            Macro::the().replay(view);
+        }
+        return times.value();
+    });
+}
+
+void cmd_macro_replay_times(pBufferView const &view, JSONValue const &)
+{
+    MiniBuffer::query(view, L"Repeat macro", do_macro_replay_times);
+}
+
+// Runs the macro with the cursor at the start of every line of the
+// selection. A selection ending at the start of a line doesn't include that
+// line. Lines added or removed by the macro are skipped over.
+void cmd_macro_replay_region(pBufferView const &view, JSONValue const &)
+{
+    auto sel = view->selection();
+    if (!sel.has_value()) {
+        Aragorn::set_message("No region selected");
+        return;
+    }
+    view->clear_selection();
+    replay_macro(view, [&view, &sel](pBuffer const &buffer) -> size_t {
+        auto   line = static_cast<ptrdiff_t>(buffer->line_for_index(sel->coords[0]));
+        auto   last = static_cast<ptrdiff_t>(buffer->line_for_index(sel->coords[1]));
+        size_t count = 0;
+        if (last > line && buffer->lines[last].begin() == sel->coords[1]) {
+            --last;
+        }
+        for (; line <= last && line < static_cast<ptrdiff_t>(buffer->lines.size()); ++line, ++count) {
+            auto lines_before = static_cast<ptrdiff_t>(buffer->lines.size());
+            view->move_cursor(BufferView::CursorMovement::by_index(buffer->lines[line].begin()));
+            Macro::the().replay(view);
+            auto added = static_cast<ptrdiff_t>(buffer->lines.size()) - lines_before;
+            line = std::max<ptrdiff_t>(line + added, 0);
+            last += added;
+        }
+        return count;
+    });
+}
+
 BufferView::BufferView(pWidget const &editor, pBuffer buf)
     : Widget(editor)
     , m_buf(std::move(buf))
@@ -374,24 +643,31 @@ void BufferView::initialize()
 {
     add_command<BufferView>("cursor-up", cmd_up)
         .bind(KeyCombo { KEY_UP, KModNone })
-        .bind(KeyCombo { KEY_UP, KModShift });
+        .bind(KeyCombo { KEY_UP, KModShift })
+        .allow_headless();
     add_command<BufferView>("select-word", cmd_select_word)
-        .bind(KeyCombo { KEY_UP, KModAlt });
+        .bind(KeyCombo { KEY_UP, KModAlt })
+        .allow_headless();
     add_command<BufferView>("cursor-down", cmd_down)
         .bind(KeyCombo { KEY_DOWN, KModNone })
-        .bind(KeyCombo { KEY_DOWN, KModShift });
+        .bind(KeyCombo { KEY_DOWN, KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-left", cmd_left)
         .bind(KeyCombo { KEY_LEFT, KModNone })
-        .bind(KeyCombo { KEY_LEFT, KModShift });
+        .bind(KeyCombo { KEY_LEFT, KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-word-left", cmd_word_left)
         .bind(KeyCombo { KEY_LEFT, KModAlt })
-        .bind(KeyCombo { KEY_LEFT, KModAlt | KModShift });
+        .bind(KeyCombo { KEY_LEFT, KModAlt | KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-right", cmd_right)
         .bind(KeyCombo { KEY_RIGHT, KModNone })
-        .bind(KeyCombo { KEY_RIGHT, KModShift });
+        .bind(KeyCombo { KEY_RIGHT, KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-word-right", cmd_word_right)
         .bind(KeyCombo { KEY_RIGHT, KModAlt })
-        .bind(KeyCombo { KEY_LEFT, KModAlt | KModShift });
+        .bind(KeyCombo { KEY_LEFT, KModAlt | KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-page-up", cmd_page_up)
         .bind(KeyCombo { KEY_PAGE_UP, KModNone })
         .bind(KeyCombo { KEY_PAGE_UP, KModShift })
@@ -406,37 +682,63 @@ void BufferView::initialize()
         .bind(KeyCombo { KEY_HOME, KModNone })
         .bind(KeyCombo { KEY_HOME, KModShift })
         .bind(KeyCombo { KEY_LEFT, KModSuper })
-        .bind(KeyCombo { KEY_LEFT, KModSuper | KModShift });
+        .bind(KeyCombo { KEY_LEFT, KModSuper | KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-top", cmd_top_of_buffer)
         .bind(KeyCombo { KEY_HOME, KModControl })
-        .bind(KeyCombo { KEY_HOME, KModSuper | KModShift });
+        .bind(KeyCombo { KEY_HOME, KModSuper | KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-end", cmd_end_of_line)
         .bind(KeyCombo { KEY_END, KModNone })
         .bind(KeyCombo { KEY_END, KModShift })
         .bind(KeyCombo { KEY_RIGHT, KModSuper })
-        .bind(KeyCombo { KEY_RIGHT, KModSuper | KModShift });
+        .bind(KeyCombo { KEY_RIGHT, KModSuper | KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-top", cmd_top_of_buffer)
         .bind(KeyCombo { KEY_HOME, KModControl })
-        .bind(KeyCombo { KEY_HOME, KModControl | KModShift });
+        .bind(KeyCombo { KEY_HOME, KModControl | KModShift })
+        .allow_headless();
     add_command<BufferView>("cursor-bottom", cmd_bottom_of_buffer)
         .bind(KeyCombo { KEY_END, KModControl })
-        .bind(KeyCombo { KEY_END, KModControl | KModShift });
+        .bind(KeyCombo { KEY_END, KModControl | KModShift })
+        .allow_headless();
     add_command<BufferView>("split-line", cmd_split_line)
         .bind(KeyCombo { KEY_ENTER, KModNone })
-        .bind(KeyCombo { KEY_KP_ENTER, KModNone });
+        .bind(KeyCombo { KEY_KP_ENTER, KModNone })
+        .allow_headless();
     add_command<BufferView>("insert-tab", cmd_insert_tab)
-        .bind(KeyCombo { KEY_TAB, KModNone });
+        .bind(KeyCombo { KEY_TAB, KModNone })
+        .allow_headless();
+    add_command<BufferView>("complete", cmd_complete)
+        .bind(KeyCombo { KEY_SPACE, KModControl });
     add_command<BufferView>("merge-lines", cmd_merge_lines)
-        .bind(KeyCombo { KEY_J, KModShift | KModControl });
+        .bind(KeyCombo { KEY_J, KModShift | KModControl })
+        .allow_headless();
     add_command<BufferView>("matching-brace", cmd_matching_brace)
         .bind(KeyCombo { KEY_M, KModControl })
-        .bind(KeyCombo { KEY_M, KModControl | KModShift });
+        .bind(KeyCombo { KEY_M, KModControl | KModShift })
+        .allow_headless();
     add_command<BufferView>("backspace", cmd_backspace)
-        .bind(KeyCombo { KEY_BACKSPACE, KModNone });
+        .bind(KeyCombo { KEY_BACKSPACE, KModNone })
+        .allow_headless();
     add_command<BufferView>("delete-current-char", cmd_delete_current_char)
-        .bind(KeyCombo { KEY_DELETE, KModNone });
+        .bind(KeyCombo { KEY_DELETE, KModNone })
+        .allow_headless();
     add_command<BufferView>("clear-selection", cmd_clear_selection)
-        .bind(KeyCombo { KEY_ESCAPE, KModNone });
+        .bind(KeyCombo { KEY_ESCAPE, KModNone })
+        .allow_headless();
+    add_command<BufferView>("caret-add-above", cmd_add_caret_above)
+        .bind(KeyCombo { KEY_UP, KModControl | KModAlt })
+        .allow_headless();
+    add_command<BufferView>("caret-add-below", cmd_add_caret_below)
+        .bind(KeyCombo { KEY_DOWN, KModControl | KModAlt })
+        .allow_headless();
+    add_command<BufferView>("caret-add-next-match", cmd_add_caret_at_next_match)
+        .bind(KeyCombo { KEY_D, KModSuper })
+        .allow_headless();
+    add_command<BufferView>("caret-split-selection", cmd_split_selection_into_lines)
+        .bind(KeyCombo { KEY_L, KModSuper | KModShift })
+        .allow_headless();
     add_command<BufferView>("copy-selection", cmd_copy)
         .bind(KeyCombo { KEY_C, KModSuper });
     add_command<BufferView>("cut-selection", cmd_cut)
@@ -444,21 +746,49 @@ void BufferView::initialize()
     add_command<BufferView>("paste-from-clipboard", cmd_paste)
         .bind(KeyCombo { KEY_V, KModSuper });
     add_command<BufferView>("editor-undo", cmd_undo)
-        .bind(KeyCombo { KEY_Z, KModSuper });
+        .bind(KeyCombo { KEY_Z, KModSuper })
+        .allow_headless();
     add_command<BufferView>("editor-redo", cmd_redo)
-        .bind(KeyCombo { KEY_Z, KModSuper | KModShift });
+        .bind(KeyCombo { KEY_Z, KModSuper | KModShift })
+        .allow_headless();
     add_command<BufferView>("editor-find", cmd_find)
-        .bind(KeyCombo { KEY_F, KModSuper });
+        .bind(KeyCombo { KEY_F, KModSuper })
+        .allow_headless(check_find_arguments);
     add_command<BufferView>("editor-find-next", cmd_find_next)
-        .bind(KeyCombo { KEY_G, KModSuper });
+        .bind(KeyCombo { KEY_G, KModSuper })
+        .allow_headless();
     add_command<BufferView>("editor-goto", cmd_goto)
         .bind(KeyCombo { KEY_L, KModSuper });
+    add_command<BufferView>("editor-rename", cmd_rename)
+        .bind(KeyCombo { KEY_F2, KModNone });
+    add_command<BufferView>("editor-undo-workspace-edit", cmd_undo_workspace_edit)
+        .bind(KeyCombo { KEY_Z, KModSuper | KModAlt });
+    add_command<BufferView>("editor-format", cmd_format)
+        .bind(KeyCombo { KEY_F, KModControl | KModShift });
+    add_command<BufferView>("editor-trim-trailing-whitespace", cmd_trim_trailing_whitespace)
+        .allow_headless();
+    add_command<BufferView>("editor-insert-final-newline", cmd_insert_final_newline)
+        .allow_headless();
     add_command<BufferView>("editor-find-replace", cmd_find_replace)
-        .bind(KeyCombo { KEY_R, KModSuper });
+        .bind(KeyCombo { KEY_R, KModSuper })
+        .allow_headless(check_find_replace_arguments);
     add_command<BufferView>("editor-save", cmd_save)
-        .bind(KeyCombo { KEY_S, KModControl });
+        .bind(KeyCombo { KEY_S, KModControl })
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_S, KModControl } });
     add_command<BufferView>("editor-save-as", cmd_save_as)
         .bind(KeyCombo { KEY_S, KModControl | KModAlt });
+    add_command<BufferView>("macro-start-recording", cmd_macro_start)
+        .bind(KeyCombo { KEY_F3, KModNone })
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_NINE, KModShift } });
+    add_command<BufferView>("macro-stop-recording", cmd_macro_stop)
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_ZERO, KModShift } });
+    add_command<BufferView>("macro-replay", cmd_macro_replay)
+        .bind(KeyCombo { KEY_F4, KModNone })
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_E, KModNone } });
+    add_command<BufferView>("macro-replay-times", cmd_macro_replay_times)
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_K, KModControl }, { KEY_N, KModNone } });
+    add_command<BufferView>("macro-replay-region", cmd_macro_replay_region)
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_K, KModControl }, { KEY_R, KModNone } });
 }
 
 void BufferView::unselected()
@@ -578,8 +908,28 @@ void BufferView::delete_selection()
     del(sel->coords[0], sel->coords[1] - sel->coords[0]);
 }
 
+// The text a caret's edit replaces: its selection, or nothing at its
+// position.
+static std::pair<size_t, size_t> caret_span(BufferView::Caret const &caret)
+{
+    if (!caret.mark.has_value()) {
+        return { caret.index, caret.index };
+    }
+    return { std::min(*caret.mark, caret.index), std::max(*caret.mark, caret.index) };
+}
+
 void BufferView::backspace()
 {
+    if (has_carets()) {
+        edit_at_carets([](Caret const &caret) -> RangeEdit {
+            auto [start, end] = caret_span(caret);
+            if (start == end && start > 0) {
+                --start;
+            }
+            return { start, end, {} };
+        });
+        return;
+    }
     if (!has_selection()) {
         if (cursor != 0) {
             del(cursor - 1, 1);
@@ -587,10 +937,21 @@ void BufferView::backspace()
     } else {
         delete_selection();
     }
+    update_completion();
 }
 
 void BufferView::delete_current_char()
 {
+    if (has_carets()) {
+        edit_at_carets([this](Caret const &caret) -> RangeEdit {
+            auto [start, end] = caret_span(caret);
+            if (start == end && end < m_buf->length()) {
+                ++end;
+            }
+            return { start, end, {} };
+        });
+        return;
+    }
     if (!has_selection()) {
         if (cursor < m_buf->length()) {
             del(cursor, 1);
@@ -615,7 +976,14 @@ bool BufferView::character(int ch)
     if (m_buf->read_only) {
         return false;
     }
-    size_t at = cursor;
+    if (has_carets()) {
+        cancel_completion();
+        edit_at_carets([ch](Caret const &caret) -> RangeEdit {
+            auto [start, end] = caret_span(caret);
+            return { start, end, rune_string { (wchar_t const *) &ch, 1 } };
+        });
+        return true;
+    }
     if (auto sel = selection(); sel.has_value()) {
         switch (ch) {
         case '(':
@@ -639,7 +1007,12 @@ bool BufferView::character(int ch)
             break;
         }
     }
-    insert(at, rune_string { (wchar_t const *) &ch, 1 });
+    insert(cursor, rune_string { (wchar_t const *) &ch, 1 });
+    if (isalnum(ch) || ch == '_') {
+        update_completion();
+    } else {
+        cancel_completion();
+    }
     return true;
 }
 
@@ -648,10 +1021,17 @@ void BufferView::insert_string(rune_view const &sv)
     if (m_buf->read_only) {
         return;
     }
-    auto at = cursor;
+    if (has_carets()) {
+        edit_at_carets([&sv](Caret const &caret) -> RangeEdit {
+            auto [start, end] = caret_span(caret);
+            return { start, end, rune_string { sv } };
+        });
+        return;
+    }
     if (has_selection()) {
         delete_selection();
     }
+    auto at = cursor;
     insert(at, sv);
     move_cursor(CursorMovement::by_index(at + sv.length()));
 }
@@ -669,6 +1049,7 @@ void BufferView::draw()
         auto cursor_pos = m_buf->index_to_position(cursor, { { cursor_col, cursor_line } });
         cursor_line = cursor_pos.y;
         version = buffer()->version;
+        normalize_carets();
     }
     static size_t frame { 1 };
     draw_rectangle(0, 0, 0, 0, Theme::the().bg());
@@ -679,6 +1060,18 @@ void BufferView::draw()
     DrawText(TextFormat("cursor line: %d", cursor_line), 700, 75, 20, RAYWHITE);
     DrawText(TextFormat("cursor col: %d", cursor_col), 700, 100, 20, RAYWHITE);
 
+    m_buf->visible_lines = { top_line, top_line + lines() };
+    auto draw_caret = [this, &ed](Vector2 const &screen_pos) {
+        double time = Aragorn::the()->time - cursor_flash;
+        if (time - floor(time) < 0.5) {
+            draw_rectangle(
+                screen_pos.x,
+                screen_pos.y,
+                2,
+                ed->cell.y + 1,
+                Theme::the().fg());
+        }
+    };
     auto cursor_drawn { false };
     for (int row = 0; row < lines() && top_line + row < m_buf->lines.size(); ++row) {
         auto        lineno = top_line + row;
@@ -688,14 +1081,13 @@ void BufferView::draw()
         if (line.empty()) {
             continue;
         }
-        if (has_selection()) {
-            auto sel = selection();
+        auto draw_selection = [&](size_t sel_start, size_t sel_end) {
             auto line_start = line.begin() + left_column;
             auto line_end = min(line.end(), line_start + columns());
-            auto selection_offset = clamp(sel->coords[0] - min(sel->coords[0], line_start), 0, line_end);
+            auto selection_offset = clamp(sel_start - min(sel_start, line_start), 0, line_end);
 
-            if (sel->coords[0] < line_end && sel->coords[1] > line.begin()) {
-                auto width = sel->coords[1] - max(sel->coords[0], line_start);
+            if (sel_start < line_end && sel_end > line.begin()) {
+                auto width = sel_end - max(sel_start, line_start);
                 if (width > line_len - selection_offset) {
                     width = columns() - selection_offset;
                 }
@@ -706,7 +1098,20 @@ void BufferView::draw()
                     ed->cell.y + 5.0f,
                     Theme::the().selection_bg());
             }
+        };
+        if (auto sel = selection(); sel.has_value()) {
+            draw_selection(sel->coords[0], sel->coords[1]);
+        }
+        for (auto const &caret : m_carets) {
+            if (auto [start, end] = caret_span(caret); start != end) {
+                draw_selection(start, end);
+            }
         }
+        auto caret = std::ranges::lower_bound(m_carets, line.begin(), {}, &Caret::index);
+        // Semantic tokens are laid over the lexical ones. Characters are
+        // visited left to right, so the spans are walked along with them.
+        auto const &spans = m_buf->semantic_overlay.at_line(lineno);
+        auto        span = spans.begin();
         for (auto const &token : line.tokens) {
             auto start_col = token.column();
             // token ends before left edge
@@ -741,17 +1146,15 @@ void BufferView::draw()
                 };
 
                 if (!cursor_drawn && (ch_ix >= cursor || (cursor_line == lineno && token.kind() == TokenKind::EndOfLine))) {
-                    double time = Aragorn::the()->time - cursor_flash;
-                    if (time - floor(time) < 0.5) {
-                        draw_rectangle(
-                            screen_pos.x,
-                            screen_pos.y,
-                            2,
-                            ed->cell.y + 1,
-                            Theme::the().fg());
-                    }
+                    draw_caret(screen_pos);
                     cursor_drawn = true;
                 }
+                while (caret != m_carets.end() && caret->index < ch_ix) {
+                    ++caret;
+                }
+                if (caret != m_carets.end() && caret->index == ch_ix) {
+                    draw_caret(screen_pos);
+                }
                 switch (token.kind()) {
                 case TokenKind::EndOfFile:
                     break;
@@ -760,14 +1163,21 @@ void BufferView::draw()
                 case TokenKind::Tab:
                     render_texture(screen_pos.x, screen_pos.y, Aragorn::the()->tab_char, static_cast<Colours>(token).fg());
                     break;
-                default:
+                default: {
+                    auto const offset = ch_ix - line.begin();
+                    while (span != spans.end() && span->column + span->length <= offset) {
+                        ++span;
+                    }
+                    auto const colours = (span != spans.end() && span->column <= offset)
+                        ? Theme::the().get_colours(span->scope)
+                        : static_cast<Colours>(token);
                     auto const ch = m_buf->at(ch_ix);
                     render_codepoint(
                         screen_pos.x, screen_pos.y,
                         ch,
                         Aragorn::the()->font.value(),
-                        static_cast<Colours>(token).fg());
-                    break;
+                        colours.fg());
+                } break;
                 }
             }
         }
@@ -775,6 +1185,15 @@ void BufferView::draw()
     if (buffer()->mode()) {
         buffer()->mode()->draw();
     }
+    if (m_completion != nullptr) {
+        if (word_start() != m_completion->word_start()) {
+            cancel_completion();
+        } else if (!m_completion->filter(MUST_EVAL(to_utf8(completion_prefix()))).empty()) {
+            Aragorn::the()->draw_floating(self(), [](pWidget const &target) {
+                std::dynamic_pointer_cast<BufferView>(target)->draw_completion();
+            });
+        }
+    }
 
     for (auto const g : Aragorn::the()->guides) {
         if (g > left_column && g < left_column + columns()) {
@@ -1047,7 +1466,9 @@ bool BufferView::find_first(rune_view const &pattern)
 
 bool BufferView::find_next()
 {
-    assert(!m_find_text.empty());
+    if (m_find_text.empty()) {
+        return false;
+    }
     auto const &b = buffer();
     auto        pos = b->find(m_find_text, cursor);
     if (pos == std::string::npos) {
@@ -1079,4 +1500,258 @@ void BufferView::replace()
     insert(cursor, m_replacement);
 }
 
+bool BufferView::has_carets() const
+{
+    return !m_carets.empty();
+}
+
+void BufferView::clear_carets()
+{
+    m_carets.clear();
+}
+
+// The view's own cursor moves to the new line; a caret stays behind in its
+// place.
+void BufferView::add_caret_above()
+{
+    if (cursor_line == 0) {
+        return;
+    }
+    m_carets.push_back({ cursor });
+    move_cursor(CursorMovement::by_position(cursor_line - 1, cursor_col));
+    normalize_carets();
+}
+
+void BufferView::add_caret_below()
+{
+    if (cursor_line + 1 >= m_buf->lines.size()) {
+        return;
+    }
+    m_carets.push_back({ cursor });
+    move_cursor(CursorMovement::by_position(cursor_line + 1, cursor_col));
+    normalize_carets();
+}
+
+// Without a selection, this selects the word at the cursor. With one, the
+// selection stays as a caret and the next occurrence of its text is
+// selected.
+bool BufferView::add_caret_at_next_match()
+{
+    auto sel = selection();
+    if (!sel.has_value()) {
+        select_word();
+        return has_selection();
+    }
+    auto text = m_buf->substr(sel->coords[0], sel->coords[1] - sel->coords[0]);
+    auto pos = m_buf->find(text, sel->coords[1]);
+    if (pos == rune_view::npos) {
+        pos = m_buf->find(text);
+    }
+    auto taken = [pos](Caret const &caret) { return caret_span(caret).first == pos; };
+    if (pos == rune_view::npos || pos == sel->coords[0] || std::ranges::any_of(m_carets, taken)) {
+        return false;
+    }
+    m_carets.push_back({ cursor, m_selection });
+    set_mark(pos);
+    move_cursor(CursorMovement::by_index(pos + text.length(), true));
+    normalize_carets();
+    return true;
+}
+
+// Puts a caret at the end of every line of the selection but the last. The
+// view's cursor goes to the end of the selection.
+void BufferView::split_selection_into_lines()
+{
+    auto sel = selection();
+    if (!sel.has_value()) {
+        return;
+    }
+    auto first = m_buf->line_for_index(sel->coords[0]);
+    auto last = m_buf->line_for_index(sel->coords[1]);
+    if (last > first && m_buf->lines[last].begin() == sel->coords[1]) {
+        --last;
+    }
+    for (auto lineno = first; lineno < last; ++lineno) {
+        m_carets.push_back({ m_buf->lines[lineno].tokens.back().index() });
+    }
+    move_cursor(CursorMovement::by_index(std::min(sel->coords[1], m_buf->lines[last].tokens.back().index())));
+    normalize_carets();
+}
+
+// Keeps the carets sorted, within the text, and apart from each other and
+// from the view's cursor.
+void BufferView::normalize_carets()
+{
+    for (auto &caret : m_carets) {
+        caret.index = std::min(caret.index, m_buf->length());
+        if (caret.mark.has_value()) {
+            caret.mark = std::min(*caret.mark, m_buf->length());
+        }
+    }
+    std::erase_if(m_carets, [this](Caret const &caret) { return caret.index == cursor; });
+    std::ranges::sort(m_carets, {}, &Caret::index);
+    auto duplicates = std::ranges::unique(m_carets, {}, &Caret::index);
+    m_carets.erase(duplicates.begin(), duplicates.end());
+}
+
+// Every caret, the view's cursor included, gets the edit make_edit returns
+// for it. The buffer applies all of them as one replacement: one undo step,
+// one re-lex and one change for the language server, however many carets
+// there are. Each caret ends up after the text inserted for it.
+void BufferView::edit_at_carets(std::function<RangeEdit(Caret const &)> const &make_edit)
+{
+    if (m_buf->read_only) {
+        return;
+    }
+    struct Placement {
+        size_t start;
+        size_t removed;
+        size_t inserted;
+        bool   own;
+    };
+    std::vector<RangeEdit> edits;
+    std::vector<Placement> placements;
+    edits.reserve(m_carets.size() + 1);
+    placements.reserve(m_carets.size() + 1);
+    auto add = [&](Caret const &caret, bool own) {
+        auto &edit = edits.emplace_back(make_edit(caret));
+        placements.emplace_back(edit.start, edit.end - edit.start, edit.text.length(), own);
+    };
+    add({ cursor, m_selection }, true);
+    for (auto const &caret : m_carets) {
+        add(caret, false);
+    }
+    std::ranges::stable_sort(placements, {}, &Placement::start);
+    if (auto err = m_buf->apply_edits(std::move(edits)); err.is_error()) {
+        Aragorn::set_message(err.error().description);
+        return;
+    }
+    m_carets.clear();
+    size_t own = 0;
+    size_t grown = 0;
+    size_t shrunk = 0;
+    for (auto const &placement : placements) {
+        auto at = placement.start + grown - shrunk + placement.inserted;
+        grown += placement.inserted;
+        shrunk += placement.removed;
+        if (placement.own) {
+            own = at;
+        } else {
+            m_carets.push_back({ at });
+        }
+    }
+    move_cursor(CursorMovement::by_index(own));
+    normalize_carets();
+}
+
+// Completion only covers the identifier the cursor is in. Moving the cursor
+// out of it, or typing something that isn't part of an identifier, ends it.
+size_t BufferView::word_start() const
+{
+    auto ret = cursor;
+    while (ret > 0 && (isalnum((*m_buf)[ret - 1]) || (*m_buf)[ret - 1] == '_')) {
+        --ret;
+    }
+    return ret;
+}
+
+rune_string BufferView::completion_prefix() const
+{
+    auto start = word_start();
+    return m_buf->substr(start, cursor - start);
+}
+
+bool BufferView::completing() const
+{
+    return m_completion != nullptr && !m_completion->filter(MUST_EVAL(to_utf8(completion_prefix()))).empty();
+}
+
+void BufferView::complete()
+{
+    if (m_buf->read_only || m_buf->mode() == nullptr) {
+        return;
+    }
+    if (m_completion == nullptr) {
+        m_completion = std::make_shared<CompletionCache>();
+    }
+    request_completion();
+}
+
+void BufferView::request_completion()
+{
+    auto start = word_start();
+    if (m_completion->needs_request(m_buf->uri(), start)) {
+        m_completion->requested(m_buf->uri(), start);
+        m_buf->mode()->complete(cursor, m_completion);
+    }
+}
+
+void BufferView::update_completion()
+{
+    if (m_completion == nullptr) {
+        return;
+    }
+    if (word_start() != m_completion->word_start()) {
+        cancel_completion();
+        return;
+    }
+    request_completion();
+}
+
+void BufferView::select_completion(int delta)
+{
+    if (m_completion != nullptr) {
+        m_completion->select(delta);
+    }
+}
+
+void BufferView::cancel_completion()
+{
+    m_completion = nullptr;
+}
+
+// Only the accepted item is decoded completely, for the text to insert.
+bool BufferView::accept_completion()
+{
+    if (!completing()) {
+        return false;
+    }
+    auto const &candidates = m_completion->filter(MUST_EVAL(to_utf8(completion_prefix())));
+    auto        item_maybe = m_completion->results()->item(candidates[m_completion->selected()].item);
+    cancel_completion();
+    if (item_maybe.is_error()) {
+        Aragorn::set_message(std::format("Completion: {}", item_maybe.error().description));
+        return true;
+    }
+    auto const &item = item_maybe.value();
+    auto        text = item.insertText.value_or(item.label);
+    if (item.textEdit) {
+        text = std::visit([](auto const &edit) { return edit.newText; }, *item.textEdit);
+    }
+    auto start = word_start();
+    auto replacement = MUST_EVAL(to_wstring(text));
+    m_buf->replace(start, cursor - start, replacement);
+    move_cursor(CursorMovement::by_index(start + replacement.length()));
+    return true;
+}
+
+constexpr size_t CompletionRows = 10;
+
+void BufferView::draw_completion()
+{
+    auto const &ed = std::dynamic_pointer_cast<Editor>(parent);
+    auto const &candidates = m_completion->filter(MUST_EVAL(to_utf8(completion_prefix())));
+    auto        selected = m_completion->selected();
+    auto        first = (selected >= CompletionRows) ? selected - CompletionRows + 1 : 0;
+    StringList  text;
+    for (auto ix = first; ix < candidates.size() && ix < first + CompletionRows; ++ix) {
+        text.push_back(std::format("{} {}", (ix == selected) ? '>' : ' ', m_completion->results()->label(candidates[ix].item)));
+    }
+    auto column = cursor_col - std::min(cursor_col, cursor - word_start());
+    draw_hover_panel(
+        ed->cell.x * static_cast<float>(column - std::min(column, left_column)),
+        ed->cell.y * static_cast<float>(cursor_line - top_line + 1),
+        text, DARKGRAY, RAYWHITE);
+}
+
 }
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <App/Buffer.h>
+#include <App/Completion.h>
 #include <App/Widget.h>
 
 namespace Aragorn {
@@ -38,6 +39,12 @@ public:
         }
     };
 
+    // A cursor besides the view's own one, with its selection mark.
+    struct Caret {
+        size_t                index { 0 };
+        std::optional<size_t> mark {};
+    };
+
     BufferView(pWidget const &editor, pBuffer buf);
     pBuffer const             &buffer() const;
     void                       initialize() override;
@@ -88,6 +95,43 @@ public:
     void                       clear_replacement();
     void                       replace();
     void                       move_cursor(CursorMovement const &move);
+    void                       complete();
+    bool                       completing() const;
+    bool                       accept_completion();
+    void                       select_completion(int delta);
+    void                       cancel_completion();
+    bool                       has_carets() const;
+    void                       clear_carets();
+    void                       add_caret_above();
+    void                       add_caret_below();
+    bool                       add_caret_at_next_match();
+    void                       split_selection_into_lines();
+
+    // Runs move for every caret and then for the view's own cursor. The
+    // movement functions only know about the view's cursor, so each caret
+    // takes its place while move runs.
+    template<typename Fn>
+    void move_carets(Fn const &move)
+    {
+        auto const scroll = view_offset();
+        auto const position = cursor_position();
+        for (auto &caret : m_carets) {
+            std::swap(cursor, caret.index);
+            std::swap(m_selection, caret.mark);
+            auto const pos = m_buf->index_to_position(cursor);
+            cursor_line = pos.line;
+            cursor_col = pos.column;
+            move();
+            std::swap(cursor, caret.index);
+            std::swap(m_selection, caret.mark);
+        }
+        top_line = scroll.line;
+        left_column = scroll.column;
+        cursor_line = position.line;
+        cursor_col = position.column;
+        move();
+        normalize_carets();
+    }
 
     auto operator[](size_t ix) const
     {
@@ -95,6 +139,14 @@ public:
     }
 
 private:
+    size_t      word_start() const;
+    rune_string completion_prefix() const;
+    void        request_completion();
+    void        update_completion();
+    void        draw_completion();
+    void        normalize_carets();
+    void        edit_at_carets(std::function<RangeEdit(Caret const &)> const &make_edit);
+
     size_t                version { 0 };
     size_t                cursor { 0 };
     size_t                cursor_line { 0 };
@@ -109,6 +161,8 @@ private:
     pBuffer               m_buf { nullptr };
     double                clicks[3] { 0.0, 0.0, 0.0 };
     int                   num_clicks { 0 };
+    pCompletionCache      m_completion { nullptr };
+    std::vector<Caret>    m_carets {};
 };
 
 }
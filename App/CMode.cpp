@@ -4,25 +4,414 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <map>
+
 #include <App/CMode.h>
+#include <App/Completion.h>
+#include <App/WorkspaceEdit.h>
+#include <LSP/Schema/CompletionParams.h>
 #include <LSP/Schema/DidChangeTextDocumentParams.h>
 #include <LSP/Schema/DidCloseTextDocumentParams.h>
 #include <LSP/Schema/DidOpenTextDocumentParams.h>
 #include <LSP/Schema/DidSaveTextDocumentParams.h>
+#include <LSP/Schema/DocumentFormattingParams.h>
+#include <LSP/Schema/PublishDiagnosticsParams.h>
+#include <LSP/Schema/SemanticTokens.h>
+#include <LSP/Schema/SemanticTokensDelta.h>
+#include <LSP/Schema/SemanticTokensDeltaParams.h>
 #include <LSP/Schema/SemanticTokensParams.h>
+#include <LSP/Schema/SemanticTokensRangeParams.h>
 #include <LSP/Schema/TextDocumentContentChangeEvent.h>
+#include <LSP/Schema/TextDocumentPositionParams.h>
+#include <LSP/ServerPool.h>
 #include <LibCore/Utf8.h>
 
 namespace Aragorn {
 
-std::shared_ptr<::LSP::LSP> CLexer::the_lsp { nullptr };
+constexpr auto DefaultSemanticTokensDelay = std::chrono::milliseconds { 250 };
+
+// Document changes and semantic token requests are not sent right away.
+// Edits are collected per document and sent as a single didChange by
+// sync(), which runs once per frame. A semantic token request is pushed
+// back by every new index of the buffer and is only sent once the buffer
+// has been quiet for the configured delay. Until a buffer has its first
+// full set of semantic tokens, the lines in view are requested right away.
+struct PendingSync {
+    std::weak_ptr<Buffer>                       buffer;
+    int                                         version { 0 };
+    std::vector<TextDocumentContentChangeEvent> changes {};
+    std::optional<Clock::time_point>            semantic_tokens_due {};
+    bool                                        semantic_tokens_range { false };
+};
+
+static std::map<std::string, PendingSync> s_pending;
+
+static std::chrono::milliseconds semantic_tokens_delay()
+{
+    static std::optional<std::chrono::milliseconds> delay {};
+    if (!delay) {
+        int ms = DefaultSemanticTokensDelay.count();
+        MUST(Aragorn::the()->settings.get("semantic_tokens_delay").value_or(JSONValue { ms }).convert<int>(ms));
+        delay = std::chrono::milliseconds { std::max(ms, 0) };
+    }
+    return *delay;
+}
+
+static PendingSync &pending_for(pBuffer const &buffer)
+{
+    auto &ret = s_pending[buffer->uri()];
+    ret.buffer = buffer;
+    return ret;
+}
+
+static void flush_changes(std::string const &uri, PendingSync &pending)
+{
+    if (pending.changes.empty()) {
+        return;
+    }
+    DidChangeTextDocumentParams did_change;
+    did_change.textDocument.uri = uri;
+    did_change.textDocument.version = pending.version;
+    did_change.contentChanges = std::move(pending.changes);
+    pending.changes.clear();
+    if (auto lsp = CLexer::lsp(); lsp != nullptr) {
+        MUST(lsp->notification("textDocument/didChange", did_change.encode()));
+    }
+}
+
+static void flush_changes(pBuffer const &buffer)
+{
+    if (auto it = s_pending.find(buffer->uri()); it != s_pending.end()) {
+        flush_changes(it->first, it->second);
+    }
+}
+
+static RequestOptions semantic_tokens_options(pBuffer const &buffer, std::string_view const &kind)
+{
+    return RequestOptions {
+        .key = std::format("textDocument/semanticTokens{} {}", kind, buffer->uri()),
+        .is_current = [buffer = std::weak_ptr(buffer), version = buffer->version.load()]() {
+            auto b = buffer.lock();
+            return b != nullptr && b->version == version;
+        },
+    };
+}
+
+// Applies the edits of a delta result to the token array of the previous
+// result. They are applied back to front so that the start offsets of the
+// ones still to be applied remain valid.
+static bool apply_semantic_tokens_delta(std::vector<uint32_t> &data, SemanticTokensDelta const &delta)
+{
+    auto edits = delta.edits;
+    std::ranges::sort(edits, [](auto const &e1, auto const &e2) { return e1.start > e2.start; });
+    for (auto const &edit : edits) {
+        if (edit.start > data.size() || edit.deleteCount > data.size() - edit.start) {
+            return false;
+        }
+        auto start = data.begin() + static_cast<ptrdiff_t>(edit.start);
+        if (edit.data) {
+            auto overlap = std::min<size_t>(edit.deleteCount, edit.data->size());
+            std::ranges::copy_n(edit.data->begin(), static_cast<ptrdiff_t>(overlap), start);
+            if (edit.deleteCount > overlap) {
+                data.erase(start + static_cast<ptrdiff_t>(overlap), start + static_cast<ptrdiff_t>(edit.deleteCount));
+            } else {
+                data.insert(start + static_cast<ptrdiff_t>(overlap), edit.data->begin() + static_cast<ptrdiff_t>(overlap), edit.data->end());
+            }
+        } else {
+            data.erase(start, start + static_cast<ptrdiff_t>(edit.deleteCount));
+        }
+    }
+    return true;
+}
+
+static void set_semantic_tokens(pBuffer const &buffer, SemanticTokens const &tokens)
+{
+    buffer->semantic_tokens_result_id = tokens.resultId.value_or("");
+    buffer->semantic_tokens = tokens.data;
+    buffer->apply_semantic_tokens(buffer->semantic_tokens);
+}
+
+// Full and delta requests share a key, so either supersedes the other. The
+// coroutines resume on the main thread, but the buffer can still have
+// changed while the response was on its way from the reading thread.
+static Task<> request_semantic_tokens(pBuffer buffer)
+{
+    auto lsp = CLexer::lsp();
+    if (lsp == nullptr) {
+        co_return;
+    }
+    auto version = buffer->version.load();
+    if (!buffer->semantic_tokens_result_id.empty() && lsp->supports_semantic_tokens_delta()) {
+        SemanticTokensDeltaParams delta_params;
+        delta_params.textDocument.uri = buffer->uri();
+        delta_params.previousResultId = buffer->semantic_tokens_result_id;
+        auto result = co_await lsp->request<std::variant<SemanticTokens, SemanticTokensDelta>>(
+            "textDocument/semanticTokens/full/delta", delta_params, semantic_tokens_options(buffer, ""));
+        if (result.is_error()) {
+            trace(LSP, "textDocument/semanticTokens/full/delta: {}", result.error().description);
+            co_return;
+        }
+        if (buffer->version != version) {
+            co_return;
+        }
+        // A server can answer a delta request with a complete result.
+        if (std::holds_alternative<SemanticTokens>(result.value())) {
+            set_semantic_tokens(buffer, std::get<SemanticTokens>(result.value()));
+            co_return;
+        }
+        auto const &delta = std::get<SemanticTokensDelta>(result.value());
+        if (!apply_semantic_tokens_delta(buffer->semantic_tokens, delta)) {
+            trace(LSP, "Invalid edit in response to textDocument/semanticTokens/full/delta");
+            buffer->semantic_tokens_result_id.clear();
+            buffer->semantic_tokens.clear();
+            co_return;
+        }
+        buffer->semantic_tokens_result_id = delta.resultId.value_or("");
+        buffer->apply_semantic_tokens(buffer->semantic_tokens);
+        co_return;
+    }
+    SemanticTokensParams semantic_tokens_params;
+    semantic_tokens_params.textDocument.uri = buffer->uri();
+    auto result = co_await lsp->request<SemanticTokens>(
+        "textDocument/semanticTokens/full", semantic_tokens_params, semantic_tokens_options(buffer, ""));
+    if (result.is_error()) {
+        trace(LSP, "textDocument/semanticTokens/full: {}", result.error().description);
+        co_return;
+    }
+    if (buffer->version == version) {
+        set_semantic_tokens(buffer, result.value());
+    }
+}
+
+// Range results only cover part of the document and can't serve as the
+// base of a delta request, so they are applied but not kept.
+static Task<> request_semantic_tokens_range(pBuffer buffer)
+{
+    auto lsp = CLexer::lsp();
+    auto [first, last] = buffer->visible_lines;
+    last = std::min(last, buffer->lines.size());
+    if (lsp == nullptr || first >= last || !lsp->supports_semantic_tokens_range()) {
+        co_return;
+    }
+    auto                      version = buffer->version.load();
+    SemanticTokensRangeParams range_params;
+    range_params.textDocument.uri = buffer->uri();
+    range_params.range.start.line = first;
+    range_params.range.start.character = 0;
+    range_params.range.end.line = last;
+    range_params.range.end.character = 0;
+    auto result = co_await lsp->request<SemanticTokens>(
+        "textDocument/semanticTokens/range", range_params, semantic_tokens_options(buffer, "/range"));
+    if (result.is_error()) {
+        trace(LSP, "textDocument/semanticTokens/range: {}", result.error().description);
+        co_return;
+    }
+    if (buffer->version == version && buffer->semantic_tokens.empty()) {
+        buffer->apply_semantic_tokens(result.value().data);
+    }
+}
 
 std::shared_ptr<::LSP::LSP> CLexer::lsp()
 {
-    if (the_lsp == nullptr) {
-        the_lsp = Widget::make<::LSP::LSP>();
+    return ServerPool::the().server_for("c");
+}
+
+// Runs on the thread reading from the server, so a flood of diagnostics is
+// decoded and indexed without holding up the main thread. Only installing
+// the index is left to the main thread.
+//
+// The document versions sent to the server are buffer versions. A set of
+// diagnostics for an older version has positions from before the edits
+// since, which the buffer's index has already been shifted past. It is
+// dropped, and the index is kept until the server publishes for the text
+// as it is now.
+static void publish_diagnostics(std::string_view const &message)
+{
+    PublishDiagnosticsParams params;
+    if (auto err = read_notification_params(message, params); err.is_error()) {
+        trace(LSP, "textDocument/publishDiagnostics: {}", err.error().description);
+        return;
     }
-    return the_lsp;
+    auto index = std::make_shared<DiagnosticIndex>(std::move(params.diagnostics));
+    Aragorn::the()->post([uri = std::move(params.uri), version = params.version, index]() {
+        for (auto const &buffer : Aragorn::the()->buffers) {
+            if (buffer->uri() != uri) {
+                continue;
+            }
+            if (version && static_cast<size_t>(*version) != buffer->version) {
+                trace(LSP, "Dropping diagnostics for version {} of {}, which is at version {}", *version, uri, buffer->version.load());
+                return;
+            }
+            buffer->diagnostics = std::move(*index);
+            return;
+        }
+    },
+        TaskPriority::Background);
+}
+
+void CLexer::register_notifications()
+{
+    ServerPool::the().on_notification("textDocument/publishDiagnostics", publish_diagnostics);
+}
+
+struct NextFrame {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) const { Aragorn::the()->post([handle]() { handle.resume(); }); }
+    void await_resume() const noexcept { }
+};
+
+// Edits the buffer and asks for its semantic tokens after each edit, going
+// through the same path as typing does. The edit is undone in the next
+// iteration. The request is made here instead of after the debounce delay,
+// so the one scheduled by the edit is cancelled.
+static Task<> run_benchmark(pBuffer buffer, int iterations)
+{
+    auto lsp = CLexer::lsp();
+    if (lsp == nullptr) {
+        co_return;
+    }
+    while (!lsp->ready()) {
+        co_await NextFrame {};
+    }
+    lsp->statistics.reset();
+    for (auto ix = 0; ix < 2 * iterations; ++ix) {
+        if (ix % 2 == 0) {
+            buffer->insert(0, " ");
+        } else {
+            buffer->undo();
+        }
+        if (auto it = s_pending.find(buffer->uri()); it != s_pending.end()) {
+            it->second.semantic_tokens_due.reset();
+            it->second.semantic_tokens_range = false;
+        }
+        co_await NextFrame {};
+        co_await request_semantic_tokens(buffer);
+    }
+    auto report = lsp->statistics.report();
+    lsp->log->append(std::format("Benchmark: {}\n", report));
+    Aragorn::the()->set_message(report);
+}
+
+void CLexer::benchmark(pBuffer const &buffer, int iterations)
+{
+    if (buffer->name.empty()) {
+        return;
+    }
+    run_benchmark(buffer, iterations).detach();
+}
+
+// The response is indexed on the thread reading from the server, so the
+// main thread only has to install it in the cache. It is not dropped when
+// the buffer changes while the request is pending, because the cache
+// filters the results for what has been typed since.
+void CLexer::complete(pBuffer const &buffer, size_t at, std::shared_ptr<CompletionCache> const &cache)
+{
+    auto lsp = CLexer::lsp();
+    if (buffer->name.empty() || lsp == nullptr) {
+        return;
+    }
+    flush_changes(buffer);
+    auto             pos = buffer->index_to_position(at);
+    CompletionParams params;
+    params.textDocument.uri = buffer->uri();
+    params.position.line = pos.line;
+    params.position.character = pos.column;
+    auto on_response = [cache = std::weak_ptr(cache), uri = buffer->uri(), word_start = cache->word_start()](Decoded<std::string_view> const &message) {
+        if (message.is_error()) {
+            return;
+        }
+        auto results = CompletionResults::index(message.value());
+        if (results.is_error()) {
+            trace(LSP, "textDocument/completion: {}", results.error().description);
+            return;
+        }
+        Aragorn::the()->post([cache, uri, word_start, results = results.value()]() {
+            if (auto c = cache.lock(); c != nullptr) {
+                c->set_results(uri, word_start, results);
+            }
+        });
+    };
+    MUST(lsp->message(nullptr, "textDocument/completion", params.encode(),
+        RequestOptions {
+            .format = ResponseFormat::Text,
+            .key = std::format("textDocument/completion {}", buffer->uri()),
+            .on_response = on_response,
+        }));
+}
+
+// The edits are dropped if the buffer changed while the server was
+// formatting it.
+static Task<> request_formatting(pBuffer buffer)
+{
+    auto lsp = CLexer::lsp();
+    if (lsp == nullptr) {
+        co_return;
+    }
+    flush_changes(buffer);
+    DocumentFormattingParams params;
+    params.textDocument.uri = buffer->uri();
+    params.options.tabSize = LexerMode<CLexer>::config_tab_size;
+    params.options.insertSpaces = true;
+    auto edits = co_await lsp->request<std::vector<TextEdit>>("textDocument/formatting", params,
+        RequestOptions {
+            .key = std::format("textDocument/formatting {}", buffer->uri()),
+            .is_current = [buffer = std::weak_ptr(buffer), version = buffer->version.load()]() {
+                auto b = buffer.lock();
+                return b != nullptr && b->version == version;
+            },
+        });
+    if (edits.is_error()) {
+        Aragorn::set_message(std::format("Format: {}", edits.error().description));
+        co_return;
+    }
+    if (auto err = buffer->apply_text_edits(edits.value()); err.is_error()) {
+        Aragorn::set_message(std::format("Format: {}", err.error().description));
+    }
+}
+
+void CLexer::format(pBuffer const &buffer)
+{
+    if (buffer->name.empty() || buffer->read_only) {
+        return;
+    }
+    request_formatting(buffer).detach();
+}
+
+// There is no schema type for RenameParams or WorkspaceEdit, so the params
+// are built and the result is read as plain JSON.
+static Task<> request_rename(pBuffer buffer, size_t at, std::string new_name)
+{
+    auto lsp = CLexer::lsp();
+    if (lsp == nullptr) {
+        co_return;
+    }
+    flush_changes(buffer);
+    auto                       pos = buffer->index_to_position(at);
+    TextDocumentPositionParams position;
+    position.textDocument.uri = buffer->uri();
+    position.position.line = pos.line;
+    position.position.character = pos.column;
+    auto params = position.encode();
+    params.set("newName", JSONValue { new_name });
+    auto edit = co_await RequestAwaitable<JSONValue> { *lsp, "textDocument/rename", params, RequestOptions {} };
+    if (edit.is_error()) {
+        Aragorn::set_message(std::format("Rename: {}", edit.error().description));
+        co_return;
+    }
+    auto files = group_workspace_edit(edit.value());
+    if (files.is_error()) {
+        Aragorn::set_message(std::format("Rename: {}", files.error().description));
+        co_return;
+    }
+    WorkspaceEditor::the().apply(files.value());
+}
+
+void CLexer::rename(pBuffer const &buffer, size_t at, std::string const &new_name)
+{
+    if (buffer->name.empty() || buffer->read_only) {
+        return;
+    }
+    request_rename(buffer, at, new_name).detach();
 }
 
 void CLexer::did_open(pBuffer const &buffer)
@@ -30,12 +419,17 @@ void CLexer::did_open(pBuffer const &buffer)
     if (buffer->name.empty()) {
         return;
     }
+    auto lsp = CLexer::lsp();
+    if (lsp == nullptr) {
+        return;
+    }
+    ServerPool::the().attach(lsp);
     DidOpenTextDocumentParams did_open;
     did_open.textDocument.uri = buffer->uri();
     did_open.textDocument.languageId = "c";
-    did_open.textDocument.version = 0;
+    did_open.textDocument.version = static_cast<int>(buffer->version.load());
     did_open.textDocument.text = MUST_EVAL(to_utf8(buffer->substr(0)));
-    MUST(lsp()->notification("textDocument/didOpen", did_open.encode()));
+    MUST(lsp->notification("textDocument/didOpen", did_open.encode()));
 }
 
 void CLexer::did_change(pBuffer const &buffer, BufferEvent const &ev)
@@ -43,11 +437,8 @@ void CLexer::did_change(pBuffer const &buffer, BufferEvent const &ev)
     if (buffer->name.empty()) {
         return;
     }
-    DidChangeTextDocumentParams    did_change;
     TextDocumentContentChangeEvent contentChange;
 
-    did_change.textDocument.uri = buffer->uri();
-    did_change.textDocument.version = buffer->version;
     auto &range = std::get<TextDocumentContentChangeRange>(contentChange);
     range.range.start.line = ev.range.start.line;
     range.range.start.character = ev.range.start.column;
@@ -64,8 +455,9 @@ void CLexer::did_change(pBuffer const &buffer, BufferEvent const &ev)
     default:
         break;
     }
-    did_change.contentChanges.emplace_back(std::move(contentChange));
-    MUST(lsp()->notification("textDocument/didChange", did_change.encode()));
+    auto &pending = pending_for(buffer);
+    pending.version = buffer->version;
+    pending.changes.emplace_back(std::move(contentChange));
 }
 
 void CLexer::semantic_tokens(pBuffer const &buffer)
@@ -73,30 +465,76 @@ void CLexer::semantic_tokens(pBuffer const &buffer)
     if (buffer->name.empty()) {
         return;
     }
-    SemanticTokensParams semantic_tokens_params;
-    semantic_tokens_params.textDocument.uri = buffer->uri();
-    MUST(lsp()->message(buffer, "textDocument/semanticTokens/full", semantic_tokens_params.encode()));
+    auto &pending = pending_for(buffer);
+    pending.semantic_tokens_due = Clock::now() + semantic_tokens_delay();
+    if (buffer->semantic_tokens.empty()) {
+        pending.semantic_tokens_range = true;
+    }
+}
+
+void CLexer::sync()
+{
+    if (s_pending.empty()) {
+        return;
+    }
+    // Document changes are always sent. Semantic token requests wait while
+    // the server is behind on reading what has been written already.
+    auto lsp = CLexer::lsp();
+    if (lsp == nullptr) {
+        s_pending.clear();
+        return;
+    }
+    auto now = Clock::now();
+    auto congested = lsp->congested();
+    for (auto it = s_pending.begin(); it != s_pending.end();) {
+        auto &[uri, pending] = *it;
+        auto buffer = pending.buffer.lock();
+        if (buffer == nullptr) {
+            it = s_pending.erase(it);
+            continue;
+        }
+        flush_changes(uri, pending);
+        if (pending.semantic_tokens_range && !congested) {
+            pending.semantic_tokens_range = false;
+            request_semantic_tokens_range(buffer).detach();
+        }
+        if (pending.semantic_tokens_due && *pending.semantic_tokens_due <= now && !congested) {
+            pending.semantic_tokens_due.reset();
+            request_semantic_tokens(buffer).detach();
+        }
+        if (pending.semantic_tokens_due || pending.semantic_tokens_range) {
+            ++it;
+        } else {
+            it = s_pending.erase(it);
+        }
+    }
 }
 
 void CLexer::did_save(pBuffer const &buffer)
 {
-    if (buffer->name.empty()) {
+    auto lsp = CLexer::lsp();
+    if (buffer->name.empty() || lsp == nullptr) {
         return;
     }
+    flush_changes(buffer);
     DidSaveTextDocumentParams did_save;
     did_save.textDocument.uri = buffer->uri();
     did_save.text = MUST_EVAL(to_utf8(buffer->substr(0)));
-    MUST(lsp()->notification("textDocument/didSave", did_save.encode()));
+    MUST(lsp->notification("textDocument/didSave", did_save.encode()));
 }
 
 void CLexer::did_close(pBuffer const &buffer)
 {
-    if (buffer->name.empty()) {
+    auto lsp = CLexer::lsp();
+    if (buffer->name.empty() || lsp == nullptr) {
         return;
     }
+    // Edits that haven't been sent yet don't matter to the server anymore.
+    s_pending.erase(buffer->uri());
     DidCloseTextDocumentParams did_close;
     did_close.textDocument.uri = buffer->uri();
-    MUST(lsp()->notification("textDocument/didClose", did_close.encode()));
+    MUST(lsp->notification("textDocument/didClose", did_close.encode()));
+    ServerPool::the().detach(lsp);
 }
 
 }
@@ -318,12 +318,18 @@ struct CLexer : ModeLexer<CMatcher<BufferSource>> {
     using Keywords = CKeyword;
     using Categories = CCategory;
     static std::shared_ptr<::LSP::LSP> lsp();
+    static void                        register_notifications();
 
     static void did_open(pBuffer const &buffer);
     static void did_change(pBuffer const &buffer, BufferEvent const &ev);
     static void semantic_tokens(pBuffer const &buffer);
     static void did_save(pBuffer const &buffer);
     static void did_close(pBuffer const &buffer);
+    static void sync();
+    static void benchmark(pBuffer const &buffer, int iterations);
+    static void complete(pBuffer const &buffer, size_t at, std::shared_ptr<CompletionCache> const &cache);
+    static void format(pBuffer const &buffer);
+    static void rename(pBuffer const &buffer, size_t at, std::string const &new_name);
 
     static BufferEventListener event_listener()
     {
@@ -355,9 +361,6 @@ struct CLexer : ModeLexer<CMatcher<BufferSource>> {
             }
         };
     }
-
-private:
-    static std::shared_ptr<::LSP::LSP> the_lsp;
 };
 
 }
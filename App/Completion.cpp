@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cctype>
+
+#include <App/Completion.h>
+
+namespace Aragorn {
+
+// The <cctype> functions take an unsigned char, and the bytes of a UTF-8
+// sequence are negative as a char.
+static int lower(char ch)
+{
+    return tolower(static_cast<unsigned char>(ch));
+}
+
+static bool is_lower(char ch)
+{
+    return islower(static_cast<unsigned char>(ch)) != 0;
+}
+
+static bool is_upper(char ch)
+{
+    return isupper(static_cast<unsigned char>(ch)) != 0;
+}
+
+std::optional<int> fuzzy_score(std::string_view const &pattern, std::string_view const &candidate)
+{
+    int    score = 0;
+    size_t ix = 0;
+    auto   prev = std::string_view::npos;
+    for (auto ch : pattern) {
+        auto ch_lower = lower(ch);
+        while (ix < candidate.length() && lower(candidate[ix]) != ch_lower) {
+            ++ix;
+        }
+        if (ix == candidate.length()) {
+            return {};
+        }
+        score += 1;
+        if (ix == 0) {
+            score += 8;
+        } else if (candidate[ix - 1] == '_' || (is_lower(candidate[ix - 1]) && is_upper(candidate[ix]))) {
+            score += 6;
+        }
+        if (prev != std::string_view::npos) {
+            score += (ix == prev + 1) ? 4 : -static_cast<int>(std::min<size_t>(ix - prev - 1, 3));
+        }
+        if (candidate[ix] == ch) {
+            score += 1;
+        }
+        prev = ix++;
+    }
+    // Of two otherwise equal matches, the shorter candidate wins.
+    return score - static_cast<int>(std::min<size_t>(candidate.length() - pattern.length(), 16)) / 4;
+}
+
+/*
+ * ---------------------------------------------------------------------------
+ * -- CompletionResults
+ * ---------------------------------------------------------------------------
+ */
+
+static Decoded<std::string> optional_string(JSONTape::Ref const &ref, std::string_view const &key)
+{
+    auto value = ref.get(key);
+    if (!value || !value->is_string()) {
+        return std::string {};
+    }
+    return value->as_string();
+}
+
+// The result is either a CompletionList, a plain array of items, or null.
+Decoded<std::shared_ptr<CompletionResults>> CompletionResults::index(std::string_view const &message)
+{
+    auto ret = std::make_shared<CompletionResults>();
+    ret->m_message = message;
+    TRY(ret->m_tape.index(ret->m_message));
+    auto result = ret->m_tape.root().get("result");
+    if (!result || result->is_null()) {
+        return ret;
+    }
+    auto items = result;
+    if (result->is_object()) {
+        auto incomplete = result->get("isIncomplete");
+        ret->m_incomplete = incomplete && incomplete->text() == "true";
+        items = result->get("items");
+        if (!items) {
+            return JSONError { JSONError::Code::MissingValue, "items" };
+        }
+    }
+    if (!items->is_array()) {
+        return JSONError { JSONError::Code::TypeMismatch, "items" };
+    }
+    auto elements = items->elements();
+    ret->m_items.reserve(elements.size());
+    for (auto const &element : elements) {
+        auto filter_text = TRY_EVAL(optional_string(element, "filterText"));
+        if (filter_text.empty()) {
+            filter_text = TRY_EVAL(optional_string(element, "label"));
+        }
+        auto sort_text = TRY_EVAL(optional_string(element, "sortText"));
+        ret->m_items.push_back(Item { element, std::move(filter_text), std::move(sort_text) });
+    }
+    return ret;
+}
+
+std::string CompletionResults::label(size_t ix) const
+{
+    auto label = optional_string(m_items[ix].ref, "label");
+    return label.has_value() ? label.value() : std::string {};
+}
+
+Decoded<CompletionItem> CompletionResults::item(size_t ix) const
+{
+    return m_items[ix].ref.decode<CompletionItem>();
+}
+
+/*
+ * ---------------------------------------------------------------------------
+ * -- CompletionCache
+ * ---------------------------------------------------------------------------
+ */
+
+bool CompletionCache::needs_request(std::string const &uri, size_t word_start) const
+{
+    if (!m_requested || uri != m_uri || word_start != m_word_start) {
+        return true;
+    }
+    return m_results != nullptr && m_results->is_incomplete();
+}
+
+void CompletionCache::requested(std::string const &uri, size_t word_start)
+{
+    if (uri != m_uri || word_start != m_word_start) {
+        m_uri = uri;
+        m_word_start = word_start;
+        m_results = nullptr;
+        m_filtered = false;
+        m_candidates.clear();
+    }
+    m_requested = true;
+}
+
+void CompletionCache::set_results(std::string const &uri, size_t word_start, std::shared_ptr<CompletionResults> results)
+{
+    if (uri != m_uri || word_start != m_word_start) {
+        return;
+    }
+    m_results = std::move(results);
+    m_filtered = false;
+}
+
+std::vector<CompletionCandidate> const &CompletionCache::filter(std::string_view const &prefix)
+{
+    if (m_results == nullptr) {
+        m_candidates.clear();
+        return m_candidates;
+    }
+    if (m_filtered && prefix == m_prefix) {
+        return m_candidates;
+    }
+    std::vector<CompletionCandidate> candidates;
+    auto                             score = [this, &prefix, &candidates](size_t item) {
+        if (auto s = fuzzy_score(prefix, m_results->filter_text(item)); s) {
+            candidates.emplace_back(item, *s);
+        }
+    };
+    if (m_filtered && prefix.starts_with(m_prefix)) {
+        for (auto const &candidate : m_candidates) {
+            score(candidate.item);
+        }
+    } else {
+        for (size_t item = 0; item < m_results->size(); ++item) {
+            score(item);
+        }
+    }
+    std::ranges::sort(candidates, [this](CompletionCandidate const &a, CompletionCandidate const &b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        if (auto cmp = m_results->sort_text(a.item).compare(m_results->sort_text(b.item)); cmp != 0) {
+            return cmp < 0;
+        }
+        return a.item < b.item;
+    });
+    m_candidates = std::move(candidates);
+    m_prefix = prefix;
+    m_filtered = true;
+    m_selected = 0;
+    return m_candidates;
+}
+
+void CompletionCache::select(int delta)
+{
+    if (m_candidates.empty()) {
+        return;
+    }
+    auto count = static_cast<int>(m_candidates.size());
+    m_selected = static_cast<size_t>(((static_cast<int>(m_selected) + delta) % count + count) % count);
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LibCore/JSONTape.h>
+#include <LSP/Schema/CompletionItem.h>
+
+namespace Aragorn {
+
+using namespace LibCore;
+using namespace LSP;
+
+// Scores how well pattern matches candidate as a case-insensitive
+// subsequence. Matches at the start of the candidate or of a word in it, and
+// runs of consecutive characters, score higher. Returns an empty optional if
+// the pattern doesn't match.
+std::optional<int> fuzzy_score(std::string_view const &pattern, std::string_view const &candidate);
+
+// The response to a completion request. The response is indexed but its
+// items are not decoded: only the text needed to filter and rank them is
+// read up front, and an item is decoded completely when it is accepted.
+class CompletionResults {
+public:
+    static Decoded<std::shared_ptr<CompletionResults>> index(std::string_view const &message);
+
+    [[nodiscard]] bool                    is_incomplete() const { return m_incomplete; }
+    [[nodiscard]] size_t                  size() const { return m_items.size(); }
+    [[nodiscard]] std::string_view        filter_text(size_t ix) const { return m_items[ix].filter_text; }
+    [[nodiscard]] std::string_view        sort_text(size_t ix) const { return m_items[ix].sort_text; }
+    [[nodiscard]] std::string             label(size_t ix) const;
+    [[nodiscard]] Decoded<CompletionItem> item(size_t ix) const;
+
+private:
+    struct Item {
+        JSONTape::Ref ref;
+        std::string   filter_text;
+        std::string   sort_text;
+    };
+
+    std::string       m_message {};
+    JSONTape          m_tape {};
+    std::vector<Item> m_items {};
+    bool              m_incomplete { false };
+};
+
+struct CompletionCandidate {
+    size_t item;
+    int    score;
+};
+
+// Completion state of a view. Results are requested once per word, and
+// narrowed down locally as the word is typed. When the server reports the
+// results as incomplete, they are requested again for every keystroke.
+// Candidates for a prefix that extends the previous one are taken from the
+// previous candidates instead of from all results.
+class CompletionCache {
+public:
+    [[nodiscard]] size_t                                    word_start() const { return m_word_start; }
+    [[nodiscard]] std::shared_ptr<CompletionResults> const &results() const { return m_results; }
+    [[nodiscard]] size_t                                    selected() const { return m_selected; }
+    [[nodiscard]] bool                                      needs_request(std::string const &uri, size_t word_start) const;
+    void                                                    requested(std::string const &uri, size_t word_start);
+    void                                                    set_results(std::string const &uri, size_t word_start, std::shared_ptr<CompletionResults> results);
+    std::vector<CompletionCandidate> const                 &filter(std::string_view const &prefix);
+    void                                                    select(int delta);
+
+private:
+    std::string                        m_uri {};
+    size_t                             m_word_start { 0 };
+    bool                               m_requested { false };
+    std::shared_ptr<CompletionResults> m_results { nullptr };
+    bool                               m_filtered { false };
+    std::string                        m_prefix {};
+    std::vector<CompletionCandidate>   m_candidates {};
+    size_t                             m_selected { 0 };
+};
+
+using pCompletionCache = std::shared_ptr<CompletionCache>;
+
+}
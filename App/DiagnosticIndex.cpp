@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+
+#include <App/DiagnosticIndex.h>
+
+namespace Aragorn {
+
+DiagnosticIndex::DiagnosticIndex(std::vector<Diagnostic> diagnostics)
+{
+    m_entries.reserve(diagnostics.size());
+    for (auto &diagnostic : diagnostics) {
+        size_t first_line = diagnostic.range.start.line;
+        size_t first_column = diagnostic.range.start.character;
+        size_t last_line = diagnostic.range.end.line;
+        size_t last_column = diagnostic.range.end.character;
+        if (last_line < first_line) {
+            last_line = first_line;
+            last_column = first_column;
+        }
+        m_max_span = std::max(m_max_span, last_line - first_line);
+        m_entries.emplace_back(first_line, first_column, last_line, last_column, std::move(diagnostic));
+    }
+    std::ranges::stable_sort(m_entries, {}, &Entry::first_line);
+}
+
+std::vector<Diagnostic const *> DiagnosticIndex::at_line(size_t line) const
+{
+    std::vector<Diagnostic const *> ret;
+    for_line(line, [&ret](Entry const &entry) {
+        ret.push_back(&entry.diagnostic);
+    });
+    return ret;
+}
+
+// Severity 1 is an error, so the most severe diagnostic has the lowest
+// value. Diagnostics without a severity count as errors.
+std::optional<DiagnosticSeverity> DiagnosticIndex::severity(size_t line) const
+{
+    std::optional<DiagnosticSeverity> ret {};
+    for_line(line, [&ret](Entry const &entry) {
+        auto severity = entry.diagnostic.severity.value_or(DiagnosticSeverity::Error);
+        if (!ret || static_cast<int>(severity) < static_cast<int>(*ret)) {
+            ret = severity;
+        }
+    });
+    return ret;
+}
+
+// The text between start and old_end was replaced by text ending at
+// new_end. Positions after the replaced text move with it, and positions
+// inside it move to its start. This keeps the entries ordered. An edit can
+// stretch an entry over more lines, so m_max_span grows with it.
+void DiagnosticIndex::edit(Vec<size_t> start, Vec<size_t> old_end, Vec<size_t> new_end)
+{
+    if (m_entries.empty()) {
+        return;
+    }
+    auto before = [](size_t line, size_t column, Vec<size_t> const &pos) {
+        return line < pos.line || (line == pos.line && column < pos.column);
+    };
+    auto move = [&](size_t &line, size_t &column) {
+        if (before(line, column, start)) {
+            return;
+        }
+        if (before(line, column, old_end)) {
+            line = start.line;
+            column = start.column;
+            return;
+        }
+        if (line == old_end.line) {
+            column = column - old_end.column + new_end.column;
+        }
+        line = line - old_end.line + new_end.line;
+    };
+    auto first = (start.line > m_max_span) ? start.line - m_max_span : 0;
+    for (auto it = std::ranges::lower_bound(m_entries, first, {}, &Entry::first_line); it != m_entries.end(); ++it) {
+        if (it->first_line > old_end.line && old_end.line == new_end.line) {
+            break;
+        }
+        move(it->first_line, it->first_column);
+        move(it->last_line, it->last_column);
+        m_max_span = std::max(m_max_span, it->last_line - it->first_line);
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <App/Widget.h>
+#include <LSP/Schema/Diagnostic.h>
+
+namespace Aragorn {
+
+using namespace LSP;
+
+// The diagnostics of a buffer, ordered by the line they start on. Looking up
+// the diagnostics of a line only visits entries that can overlap it, so the
+// cost per line doesn't depend on the number of diagnostics. When lines are
+// inserted or removed the entries are moved with them instead of waiting
+// for the server to publish the diagnostics again. Edits are described the
+// same way as for SemanticOverlay::edit().
+class DiagnosticIndex {
+public:
+    DiagnosticIndex() = default;
+    explicit DiagnosticIndex(std::vector<Diagnostic> diagnostics);
+
+    [[nodiscard]] bool                             empty() const { return m_entries.empty(); }
+    [[nodiscard]] size_t                           size() const { return m_entries.size(); }
+    [[nodiscard]] std::vector<Diagnostic const *> at_line(size_t line) const;
+    [[nodiscard]] std::optional<DiagnosticSeverity> severity(size_t line) const;
+    void                                           edit(Vec<size_t> start, Vec<size_t> old_end, Vec<size_t> new_end);
+
+private:
+    struct Entry {
+        size_t     first_line;
+        size_t     first_column;
+        size_t     last_line;
+        size_t     last_column;
+        Diagnostic diagnostic;
+    };
+
+    template<typename Fn>
+    void for_line(size_t line, Fn const &fn) const
+    {
+        auto first = (line > m_max_span) ? line - m_max_span : 0;
+        auto it = std::ranges::lower_bound(m_entries, first, {}, &Entry::first_line);
+        for (; it != m_entries.end() && it->first_line <= line; ++it) {
+            if (it->last_line >= line) {
+                fn(*it);
+            }
+        }
+    }
+
+    std::vector<Entry> m_entries {};
+    size_t             m_max_span { 0 };
+};
+
+}
@@ -7,8 +7,10 @@
 #include <iostream>
 
 #include <App/Aragorn.h>
+#include <App/CMode.h>
 #include <App/Editor.h>
 #include <App/FileSelector.h>
+#include <App/LexerMode.h>
 #include <App/Modal.h>
 
 namespace Aragorn {
@@ -233,6 +235,20 @@ void cmd_close_view(pEditor const &editor, JSONValue const &)
     editor->close_view();
 }
 
+void cmd_lsp_benchmark(pEditor const &editor, JSONValue const &args)
+{
+    auto const &buffer = editor->current_buffer();
+    if (std::dynamic_pointer_cast<LexerMode<CLexer>>(buffer->mode()) == nullptr) {
+        Aragorn::set_message("LSP benchmark needs a C buffer");
+        return;
+    }
+    int iterations = 50;
+    if (args.is_integer()) {
+        MUST(args.convert<int>(iterations));
+    }
+    CLexer::benchmark(buffer, iterations);
+}
+
 /*
  * ---------------------------------------------------------------------------
  * Life cycle
@@ -249,15 +265,18 @@ Editor::Editor(pWidget const &parent)
 void Editor::initialize()
 {
     add_command<Editor>("editor-open-file", cmd_open_file)
-        .bind(KeyCombo { KEY_O, KModControl });
+        .bind(KeyCombo { KEY_O, KModControl })
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_F, KModControl } });
     add_command<Editor>("editor-find-file", cmd_find_file)
         .bind(KeyCombo { KEY_O, KModSuper });
     add_command<Editor>("editor-switch-buffer", cmd_switch_buffer)
-        .bind(KeyCombo { KEY_B, KModSuper });
+        .bind(KeyCombo { KEY_B, KModSuper })
+        .bind(KeyChord { { KEY_X, KModControl }, { KEY_B, KModNone } });
     add_command<Editor>("editor-close-buffer", cmd_close_buffer)
         .bind(KeyCombo { KEY_W, KModControl });
     add_command<Editor>("editor-close-view", cmd_close_view)
         .bind(KeyCombo { KEY_W, KModControl | KModShift });
+    add_command<Editor>("editor-lsp-benchmark", cmd_lsp_benchmark);
 }
 
 void Editor::resize()
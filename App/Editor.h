@@ -36,10 +36,9 @@ private:
 };
 
 struct Gutter : public Widget {
-    size_t  row_diagnostic_hover { 0 };
-    size_t  first_diagnostic_hover { 0 };
-    size_t  num_diagnostics_hover { 0 };
-    pEditor editor;
+    size_t     row_diagnostic_hover { 0 };
+    StringList diagnostics_hover {};
+    pEditor    editor;
 
     Gutter() = delete;
     explicit Gutter(pEditor editor);
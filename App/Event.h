@@ -121,7 +121,7 @@ struct BufferEvent {
     static BufferEvent make_replacement(EventRange const &range, size_t at, rune_string overwritten, rune_string replacement)
     {
         BufferEvent ret;
-        ret.type = BufferEventType::Delete;
+        ret.type = BufferEventType::Replace;
         ret.range = range;
         ret.position = at;
         ret.change = Replacement {
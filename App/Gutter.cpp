@@ -22,24 +22,27 @@ void Gutter::resize()
     background = DARKGRAY; // colour_to_color(Aragorn::the()->theme.gutter.bg);
 }
 
-void Gutter::draw_diagnostic_float()
+static Color severity_color(DiagnosticSeverity severity)
 {
-#if 0
-    auto  view = current_view();
-    auto  buffer = current_buffer();
-
-    StringList hover_text = { 0 };
-    for (size_t ix = first_diagnostic_hover; ix < num_diagnostics_hover; ++ix) {
-        hover_text.push_back(buffer->diagnostics[first_diagnostic_hover + ix].message);
+    switch (severity) {
+    case DiagnosticSeverity::Error:
+        return RED;
+    case DiagnosticSeverity::Warning:
+        return ORANGE;
+    default:
+        return SKYBLUE;
     }
-    if (hover_text.size() > 0) {
-        draw_hover_panel(viewport.width - 3, Aragorn::the()->cell.y * row_diagnostic_hover + 6, hover_text,
+}
+
+void Gutter::draw_diagnostic_float()
+{
+    if (!diagnostics_hover.empty()) {
+        draw_hover_panel(viewport.width - 3, editor->cell.y * row_diagnostic_hover + 6, diagnostics_hover,
             DARKGRAY, RAYWHITE);
-//            //colour_to_color(Aragorn::the()->theme.editor.bg), colour_to_color(Aragorn::the()->theme.editor.fg));
     }
-#endif
 }
 
+// Only the visible lines are looked up in the diagnostics index.
 void Gutter::draw()
 {
     auto const &view = editor->current_view();
@@ -53,40 +56,37 @@ void Gutter::draw()
             std::format("{:4}", lineno + 1),
             Aragorn::the()->font.value(),
             RAYWHITE /*colour_to_color(Aragorn::the()->theme.gutter.fg)*/);
-#if 0
-        auto &line = buffer->lines[lineno];
-        if (line->num_diagnostics > 0) {
-            widget_draw_rectangle(gutter, -6, Aragorn::the()->cell.y * row, 6, Aragorn::the()->cell.y, RED);
+        if (auto severity = buffer->diagnostics.severity(lineno); severity) {
+            draw_rectangle(-6, editor->cell.y * row, 6, editor->cell.y, severity_color(*severity));
         }
-#endif
     }
-#if 0
-    if (num_diagnostics_hover > 0) {
-        app_draw_floating(app, gutter, (WidgetDraw) draw_diagnostic_float);
+    if (!diagnostics_hover.empty()) {
+        Aragorn::the()->draw_floating(self(), [](pWidget const &target) {
+            std::dynamic_pointer_cast<Gutter>(target)->draw_diagnostic_float();
+        });
     }
-#endif
 }
 
 void Gutter::process_input()
 {
     row_diagnostic_hover = 0;
-    first_diagnostic_hover = 0;
-    num_diagnostics_hover = 0;
+    diagnostics_hover.clear();
     Vector2 mouse = GetMousePosition();
     if (contains(mouse)) {
         Vec<int>    gutter_coords = coordinates(mouse).value();
-        int         row = gutter_coords.y / Aragorn::the()->cell.y;
+        int         row = gutter_coords.y / editor->cell.y;
         auto const &view = editor->current_view();
         auto const &buffer = view->buffer();
         auto        lineno = view->view_offset().line + row;
-        auto       &line = buffer->lines[lineno];
-#if 0
-        if (line.num_diagnostics > 0) {
+        if (lineno >= buffer->lines.size()) {
+            return;
+        }
+        for (auto const *diagnostic : buffer->diagnostics.at_line(lineno)) {
+            diagnostics_hover.push_back(diagnostic->message);
+        }
+        if (!diagnostics_hover.empty()) {
             row_diagnostic_hover = row;
-            first_diagnostic_hover = line.first_diagnostic;
-            num_diagnostics_hover = line.num_diagnostics;
         }
-#endif
     }
 }
 
@@ -95,6 +95,27 @@ public:
         return Lexer::event_listener();
     }
 
+    void complete(size_t at, std::shared_ptr<CompletionCache> const &cache) override
+    {
+        if constexpr (requires { Lexer::complete(std::declval<pBuffer>(), at, cache); }) {
+            Lexer::complete(std::dynamic_pointer_cast<Buffer>(parent), at, cache);
+        }
+    }
+
+    void format() override
+    {
+        if constexpr (requires { Lexer::format(std::declval<pBuffer>()); }) {
+            Lexer::format(std::dynamic_pointer_cast<Buffer>(parent));
+        }
+    }
+
+    void rename(size_t at, std::string const &new_name) override
+    {
+        if constexpr (requires { Lexer::rename(std::declval<pBuffer>(), at, new_name); }) {
+            Lexer::rename(std::dynamic_pointer_cast<Buffer>(parent), at, new_name);
+        }
+    }
+
     void initialize_source() override
     {
         m_lexer.initialize_source(std::dynamic_pointer_cast<Buffer>(parent));
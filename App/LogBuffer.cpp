@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <limits>
+
+#include <LibCore/Utf8.h>
+
+#include <App/Aragorn.h>
+#include <App/LexerMode.h>
+#include <App/LogBuffer.h>
+
+namespace Aragorn {
+
+using namespace LibCore;
+
+LogBuffer::LogBuffer(pWidget const &parent)
+    : Buffer(parent)
+{
+    read_only = true;
+}
+
+void LogBuffer::initialize()
+{
+    m_mode = Widget::make<LexerMode<PlainTextLexer>>(std::dynamic_pointer_cast<Buffer>(self()));
+}
+
+void LogBuffer::append(std::string text)
+{
+    if (text.empty()) {
+        return;
+    }
+    m_incoming.post(std::move(text));
+}
+
+void LogBuffer::sync()
+{
+    if (m_incoming.empty()) {
+        return;
+    }
+    // The last line can be incomplete, so it is indexed again together with
+    // the new text.
+    auto first_line = lines.empty() ? 0 : lines.size() - 1;
+    set(text_size);
+    m_incoming.drain([this](std::string const &text) {
+        auto       runes_maybe = to_wstring(text);
+        auto const runes = runes_maybe.is_error()
+            ? rune_string { text.begin(), text.end() }
+            : runes_maybe.value();
+        ensure_capacity(runes.length());
+        std::ranges::copy(runes, it(cursor));
+        cursor += runes.length();
+        text_size += runes.length();
+    });
+    ++version;
+    reindex(first_line);
+    if (lines.size() > MaxLines + MaxLines / 4) {
+        trim();
+    }
+    indexed_version = version;
+}
+
+// Drops lines from the front until MaxLines are left. Trimming only once
+// a quarter more has accumulated keeps the cost of moving the text down
+// proportional to the amount appended.
+void LogBuffer::trim()
+{
+    auto drop = lines[lines.size() - MaxLines].begin();
+    set(text_size);
+    std::copy(it(drop), it(text_size), it(0));
+    text_size -= drop;
+    cursor = text_size;
+    lines.clear();
+    reindex(0);
+}
+
+void LogBuffer::reindex(size_t first_line)
+{
+    auto start = (first_line < lines.size()) ? lines[first_line].begin() : 0;
+    lines.resize(first_line);
+    split_lines(start, first_line, std::numeric_limits<size_t>::max(), lines);
+}
+
+}
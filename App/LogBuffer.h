@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <App/Buffer.h>
+#include <App/Mailbox.h>
+
+namespace Aragorn {
+
+using namespace LibCore;
+
+// Read-only buffer for logs and other system output. append() can be called
+// from any thread and never blocks; the text is added to the buffer by
+// sync(), which runs on the main thread once per frame. Appended text is
+// split into lines directly, without running the buffer's lexer and without
+// undo history, and once the buffer holds more than MaxLines lines the
+// oldest ones are dropped.
+struct LogBuffer : public Buffer {
+    static constexpr size_t MaxLines = 10000;
+
+    explicit LogBuffer(pWidget const &parent);
+    LogBuffer(LogBuffer const &) = delete;
+
+    void initialize() override;
+    void append(std::string text);
+    void sync();
+
+private:
+    void reindex(size_t first_line);
+    void trim();
+
+    Mailbox<std::string> m_incoming {};
+};
+
+using pLogBuffer = std::shared_ptr<LogBuffer>;
+
+}
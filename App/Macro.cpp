@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <App/Macro.h>
+
+namespace Aragorn {
+
+Macro &Macro::the()
+{
+    static Macro s_macro;
+    return s_macro;
+}
+
+void Macro::start()
+{
+    m_recorded.clear();
+    m_recording = true;
+}
+
+// The macro recorded last is kept if nothing was recorded this time.
+void Macro::stop()
+{
+    if (!m_recording) {
+        return;
+    }
+    m_recording = false;
+    if (!m_recorded.empty()) {
+        m_steps = std::move(m_recorded);
+    }
+    m_recorded.clear();
+}
+
+void Macro::record_command(std::string const &command, JSONValue const &arguments)
+{
+    if (!m_recording || command.starts_with("macro-")) {
+        return;
+    }
+    m_recorded.emplace_back(command, arguments);
+}
+
+void Macro::record_character(int ch)
+{
+    if (!m_recording) {
+        return;
+    }
+    if (m_recorded.empty() || !m_recorded.back().command.empty()) {
+        m_recorded.emplace_back();
+    }
+    m_recorded.back().text += static_cast<rune>(ch);
+}
+
+void Macro::replay(pWidget const &focus) const
+{
+    replay(m_steps, focus);
+}
+
+// Steps go to the same widgets they would go to from the keyboard: a
+// command to the first widget up from the focus that has it, a character
+// to the first one that takes it.
+void Macro::replay(std::vector<MacroStep> const &steps, pWidget const &focus)
+{
+    for (auto const &step : steps) {
+        if (step.command.empty()) {
+            for (auto ch : step.text) {
+                for (auto w = focus; w != nullptr; w = w->parent) {
+                    if (w->character(ch)) {
+                        break;
+                    }
+                }
+            }
+            continue;
+        }
+        focus->bubble_up([&step](pWidget const &w) {
+            if (auto it = w->commands.find(step.command); it != w->commands.end()) {
+                it->second.execute(step.arguments);
+                return true;
+            }
+            return false;
+        });
+    }
+}
+
+}
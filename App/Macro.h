@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <App/Widget.h>
+
+namespace Aragorn {
+
+using namespace LibCore;
+
+// A keyboard macro step: either a command run from the keyboard, with its
+// arguments, or a run of typed characters.
+struct MacroStep {
+    std::string command {};
+    JSONValue   arguments {};
+    rune_string text {};
+};
+
+// Records the commands run from the keyboard and the characters typed, and
+// replays them. Replaying runs every step right away, without going through
+// the app's mailbox, so a macro runs as often as asked within one frame.
+// Commands whose name starts with "macro-" are not recorded.
+class Macro {
+public:
+    static Macro &the();
+
+    void                                        start();
+    void                                        stop();
+    [[nodiscard]] bool                          recording() const { return m_recording; }
+    [[nodiscard]] std::vector<MacroStep> const &steps() const { return m_steps; }
+    void                                        record_command(std::string const &command, JSONValue const &arguments);
+    void                                        record_character(int ch);
+    void                                        replay(pWidget const &focus) const;
+    static void                                 replay(std::vector<MacroStep> const &steps, pWidget const &focus);
+
+private:
+    Macro() = default;
+
+    std::vector<MacroStep> m_steps {};
+    std::vector<MacroStep> m_recorded {};
+    bool                   m_recording { false };
+};
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace Aragorn {
+
+// Lock-free queue with any number of producers and a single consumer.
+// post() can be called from any thread and never blocks. Items are pushed
+// on the front of a linked list with a compare-and-swap; drain() takes the
+// whole list in one exchange and hands the items to the consumer in the
+// order they were posted. Items posted while draining are left for the
+// next drain().
+template<typename T>
+class Mailbox {
+public:
+    Mailbox() = default;
+    Mailbox(Mailbox const &) = delete;
+    Mailbox &operator=(Mailbox const &) = delete;
+
+    ~Mailbox()
+    {
+        auto *node = m_head.exchange(nullptr, std::memory_order_acquire);
+        while (node != nullptr) {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    void post(T item)
+    {
+        auto *node = new Node { std::move(item) };
+        node->next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+            ;
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == nullptr;
+    }
+
+    template<typename Fn>
+    size_t drain(Fn const &fn)
+    {
+        auto *node = m_head.exchange(nullptr, std::memory_order_acquire);
+        // The list holds the items newest first.
+        Node *ordered = nullptr;
+        while (node != nullptr) {
+            auto *next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+        size_t count = 0;
+        while (ordered != nullptr) {
+            std::unique_ptr<Node> current { std::exchange(ordered, ordered->next) };
+            fn(std::move(current->item));
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    struct Node {
+        T     item;
+        Node *next { nullptr };
+    };
+
+    std::atomic<Node *> m_head { nullptr };
+};
+
+}
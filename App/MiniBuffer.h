@@ -186,8 +186,11 @@ struct MiniBuffer : public Widget {
         };
 
         auto const &minibuffer = Aragorn::the()->find_by_class<MiniBuffer>();
-        assert(minibuffer != nullptr);
         assert(fnc != NULL);
+        if (minibuffer == nullptr) {
+            // Headless, there is no one to ask.
+            return;
+        }
         if (minibuffer->current_query != nullptr) {
             minibuffer->display("Minibuffer already active");
             return;
@@ -16,6 +16,8 @@ namespace Aragorn {
 
 using namespace LibCore;
 
+class CompletionCache;
+
 class DisplayToken {
 public:
     DisplayToken(size_t index, size_t length, size_t line, size_t column, TokenKind kind, Scope scope)
@@ -37,7 +39,12 @@ public:
     [[nodiscard]] size_t    line() const { return m_line; }
     [[nodiscard]] size_t    column() const { return m_column; }
     [[nodiscard]] TokenKind kind() const { return m_kind; }
-    void                    get_scope(SemanticTokenTypes semantic_type) { m_scope = Theme::the().get_scope(semantic_type); }
+
+    void shift(ptrdiff_t index, ptrdiff_t line)
+    {
+        m_index += index;
+        m_line += line;
+    }
 
 private:
     size_t    m_index;
@@ -58,6 +65,11 @@ public:
     virtual void                initialize_source() = 0;
     virtual DisplayToken        lex() = 0;
     virtual BufferEventListener event_listener() const { return nullptr; }
+    // Requests completions for the word before index at. The results are
+    // installed in the cache when they arrive.
+    virtual void                complete(size_t at, std::shared_ptr<CompletionCache> const &cache) { }
+    virtual void                format() { }
+    virtual void                rename(size_t at, std::string const &new_name) { }
 
 private:
     //
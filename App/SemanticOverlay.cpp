@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+
+#include <App/SemanticOverlay.h>
+
+namespace Aragorn {
+
+// data is the relative encoding of SemanticTokens: five integers per token,
+// the first two being the line and start column relative to the previous
+// token.
+void SemanticOverlay::set(std::vector<uint32_t> const &data)
+{
+    m_lines.clear();
+    size_t line { 0 };
+    size_t column { 0 };
+    for (size_t ix = 0; ix + 4 < data.size(); ix += 5) {
+        if (data[ix] > 0) {
+            line += data[ix];
+            column = 0;
+        }
+        column += data[ix + 1];
+        if (line >= m_lines.size()) {
+            m_lines.resize(line + 1);
+        }
+        m_lines[line].emplace_back(column, data[ix + 2], Theme::the().get_scope(static_cast<SemanticTokenTypes>(data[ix + 3])));
+    }
+}
+
+SemanticOverlay::Spans const &SemanticOverlay::at_line(size_t line) const
+{
+    static Spans const no_spans {};
+    return (line < m_lines.size()) ? m_lines[line] : no_spans;
+}
+
+// The text between start and old_end was replaced by text ending at
+// new_end.
+void SemanticOverlay::edit(Vec<size_t> start, Vec<size_t> old_end, Vec<size_t> new_end)
+{
+    if (start.line >= m_lines.size()) {
+        return;
+    }
+    Spans tail;
+    if (old_end.line < m_lines.size()) {
+        for (auto const &span : m_lines[old_end.line]) {
+            if (span.column >= old_end.column) {
+                tail.emplace_back(span.column - old_end.column + new_end.column, span.length, span.scope);
+            }
+        }
+    }
+    std::erase_if(m_lines[start.line], [&start](Span const &span) {
+        return span.column + span.length > start.column;
+    });
+    auto first = m_lines.begin() + static_cast<ptrdiff_t>(start.line) + 1;
+    auto last = m_lines.begin() + static_cast<ptrdiff_t>(std::min(old_end.line + 1, m_lines.size()));
+    first = m_lines.erase(first, last);
+    m_lines.insert(first, new_end.line - start.line, Spans {});
+    std::ranges::move(tail, std::back_inserter(m_lines[new_end.line]));
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <App/Theme.h>
+#include <App/Widget.h>
+
+namespace Aragorn {
+
+// The semantic tokens of a buffer, kept apart from the tokens produced by
+// the lexer so re-lexing doesn't lose them, and they are merged with the
+// lexical tokens when the buffer is drawn. Spans are stored per line,
+// ordered by column, with columns counted in characters from the start of
+// the line. Edits move the spans after them along with the text, and drop
+// the spans they overlap.
+class SemanticOverlay {
+public:
+    struct Span {
+        size_t column;
+        size_t length;
+        Scope  scope;
+    };
+    using Spans = std::vector<Span>;
+
+    void                       set(std::vector<uint32_t> const &data);
+    void                       clear() { m_lines.clear(); }
+    [[nodiscard]] bool         empty() const { return m_lines.empty(); }
+    [[nodiscard]] Spans const &at_line(size_t line) const;
+    void                       edit(Vec<size_t> start, Vec<size_t> old_end, Vec<size_t> new_end);
+
+private:
+    std::vector<Spans> m_lines {};
+};
+
+}
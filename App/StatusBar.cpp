@@ -9,6 +9,7 @@
 #include <App/Buffer.h>
 #include <App/Editor.h>
 #include <App/StatusBar.h>
+#include <App/WorkspaceEdit.h>
 
 namespace Aragorn {
 
@@ -75,6 +76,26 @@ struct Cursor : public Label {
     }
 };
 
+struct WorkspaceProgress : public Label {
+    explicit WorkspaceProgress(pWidget const& parent)
+        : Label(parent, "", RAYWHITE)
+    {
+        policy_size = 24;
+    }
+
+    void resize() override
+    {
+        background = Theme::the().selection_bg();
+        color = Theme::the().selection_fg();
+    }
+
+    void draw() override
+    {
+        text = WorkspaceEditor::the().progress();
+        Label::draw();
+    }
+};
+
 struct FPS : public Label {
     explicit FPS(pWidget const& parent)
         : Label(parent, "", GREEN)
@@ -115,6 +136,7 @@ void StatusBar::initialize()
     add_widget<Spacer>(SizePolicy::Characters, 1);
     add_widget<FileName>();
     add_widget<Spacer>();
+    add_widget<WorkspaceProgress>();
     add_widget<Cursor>();
     add_widget<FPS>();
 }
@@ -82,39 +82,59 @@ void Widget::WidgetCommand::execute(JSONValue const &args) const
     handler(owner, args);
 }
 
-Widget::WidgetCommand &Widget::WidgetCommand::bind(KeyCombo combo)
+Widget::WidgetCommand &Widget::WidgetCommand::bind(KeyChord const &chord)
 {
-    bindings.push_back(combo);
+    owner->keymap.bind(chord, command);
+    bindings.push_back(chord);
     return *this;
 }
 
-Widget::PendingCommand::PendingCommand(WidgetCommand const &command, JSONValue arguments)
-    : command(command)
-    , arguments(std::move(arguments))
+Widget::WidgetCommand &Widget::WidgetCommand::bind(KeyCombo combo)
 {
-    command.owner->bubble_up([this](auto const &w) -> bool {
-        if (auto app = std::dynamic_pointer_cast<App>(w)) {
-            current_focus = app->focus;
-            return true;
-        }
-        return false;
-    });
+    return bind(KeyChord { combo });
 }
 
-void Widget::PendingCommand::execute(JSONValue const &args) const
+Widget::WidgetCommand &Widget::WidgetCommand::allow_headless(ArgumentCheck check)
 {
-    command.execute(args);
-    command.owner->bubble_up([this](auto const &w) -> bool {
-        if (auto app = std::dynamic_pointer_cast<App>(w)) {
-            app->focus = current_focus;
-            return true;
+    headless = true;
+    check_arguments = std::move(check);
+    return *this;
+}
+
+// The arguments passed to the command are built here, so pressing a key
+// doesn't have to.
+void Keymap::bind(KeyChord const &chord, std::string const &command)
+{
+    assert(!chord.empty());
+    auto *keymap = this;
+    for (size_t ix = 0; ix < chord.size() - 1; ++ix) {
+        auto &binding = keymap->m_bindings[chord[ix]];
+        if (!binding.command.empty()) {
+            trace(CMD, "Binding for '{}' is shadowed by '{}'", command, binding.command);
+            return;
         }
-        return false;
-    });
+        if (binding.prefix == nullptr) {
+            binding.prefix = std::make_unique<Keymap>();
+        }
+        keymap = binding.prefix.get();
+    }
+    auto combo = chord.back();
+    auto [it, inserted] = keymap->m_bindings.try_emplace(combo);
+    if (!inserted) {
+        trace(CMD, "Binding for '{}' is shadowed by '{}'", command, it->second.prefix ? "a chord" : it->second.command);
+        return;
+    }
+    it->second.command = command;
+    it->second.arguments = JSONValue::object();
+    set(it->second.arguments, "key", combo.key);
+    set(it->second.arguments, "modifier", combo.modifier);
 }
 
-std::deque<Widget::PendingCommand> Widget::pending_commands {};
-std::mutex                         Widget::commands_mutex {};
+Keymap::Binding const *Keymap::lookup(KeyCombo combo) const
+{
+    auto it = m_bindings.find(combo);
+    return (it != m_bindings.end()) ? &it->second : nullptr;
+}
 
 Widget::Widget(pWidget parent, SizePolicy policy, float policy_size)
     : policy(policy)
@@ -123,6 +143,26 @@ Widget::Widget(pWidget parent, SizePolicy policy, float policy_size)
 {
 }
 
+// Commands can be submitted from any thread. They are executed on the main
+// thread, through the app's mailbox. A command doesn't move the focus.
+void Widget::submit(std::string_view const &command, JSONValue const &args, TaskPriority priority)
+{
+    auto name = std::string { command };
+    trace(CMD, "Submitting {}::{}({})", typeid(this).name(), name, args.serialize());
+    if (!has_command(name)) {
+        return;
+    }
+    App::the()->post([target = self(), name, args]() {
+        auto const &cmd = target->commands.at(name);
+        auto        app = App::the();
+        auto        current_focus = app->focus;
+        trace(CMD, "Executing {}({})", cmd.command, args.serialize());
+        cmd.execute(args);
+        app->focus = current_focus;
+    },
+        priority);
+}
+
 void Widget::render_sized_text_(float x, float y, rune_view const &text, Font font, float size, Color color) const
 {
     if (text.empty()) {
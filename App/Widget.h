@@ -8,7 +8,9 @@
 
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #include <raylib.h>
 
@@ -55,6 +57,15 @@ enum class SizePolicy {
     Stretch,
 };
 
+// Order in which tasks posted to the app are run within a frame. Commands
+// bound to keys run before everything else, results from language servers
+// and other background work last.
+enum class TaskPriority {
+    Input = 0,
+    Normal,
+    Background,
+};
+
 using rune = wchar_t;
 using rune_view = std::basic_string_view<rune>;
 using rune_string = std::basic_string<rune>;
@@ -156,6 +167,37 @@ struct App;
 struct KeyCombo {
     int              key;
     KeyboardModifier modifier;
+
+    bool operator==(KeyCombo const &) const = default;
+};
+
+struct KeyComboHash {
+    size_t operator()(KeyCombo const &combo) const
+    {
+        return std::hash<int> {}((combo.key << 4) | combo.modifier);
+    }
+};
+
+// A sequence of key combos pressed one after the other, like C-x C-f.
+using KeyChord = std::vector<KeyCombo>;
+
+// Key bindings of a widget, compiled into a hash table as commands are
+// bound. A key combo maps either to a command, or, if it starts a chord, to
+// the keymap for the rest of the chord. If a key combo is bound more than
+// once, the first binding wins.
+class Keymap {
+public:
+    struct Binding {
+        std::string             command {};
+        JSONValue               arguments {};
+        std::unique_ptr<Keymap> prefix { nullptr };
+    };
+
+    void                         bind(KeyChord const &chord, std::string const &command);
+    [[nodiscard]] Binding const *lookup(KeyCombo combo) const;
+
+private:
+    std::unordered_map<KeyCombo, Binding, KeyComboHash> m_bindings {};
 };
 
 constexpr auto ZeroPadding = Rect<float> { 0.0 };
@@ -173,21 +215,29 @@ private:
 
 public:
     using Handler = std::function<void(pWidget const &, JSONValue const &)>;
+    using ArgumentCheck = std::function<JSONValue::EJSON(JSONValue const &)>;
     struct WidgetCommand {
         std::string           command;
         pWidget               owner;
         Handler               handler;
-        std::vector<KeyCombo> bindings {};
+        std::vector<KeyChord> bindings {};
+        // Set for commands that don't need a window, and can be run by
+        // aragorn --batch. A command that would ask for input gets it from
+        // its arguments there, which check_arguments verifies up front.
+        bool                  headless { false };
+        ArgumentCheck         check_arguments {};
 
         WidgetCommand(std::string name, pWidget owner, Handler handler);
         WidgetCommand(WidgetCommand const &) = default;
         void           execute(JSONValue const &args) const;
+        WidgetCommand &bind(KeyChord const &chord);
         WidgetCommand &bind(KeyCombo combo);
+        WidgetCommand &allow_headless(ArgumentCheck check = {});
 
         template<typename... Args>
         WidgetCommand &bind(KeyCombo combo, Args... args)
         {
-            bindings.push_back(combo);
+            bind(combo);
             return bind(std::forward<Args>(args)...);
         }
 
@@ -197,15 +247,6 @@ public:
         }
     };
 
-    struct PendingCommand {
-        WidgetCommand const &command;
-        pWidget              current_focus;
-        JSONValue            arguments;
-
-        PendingCommand(WidgetCommand const &command, JSONValue arguments);
-        void execute(JSONValue const &args) const;
-    };
-
     Rect<float>                          viewport { 0.0 };
     Rect<float>                          padding { ZeroPadding };
     Color                                background { BLACK };
@@ -215,8 +256,7 @@ public:
     pWidget                              delegate { nullptr };
     pWidget                              memo { nullptr };
     std::map<std::string, WidgetCommand> commands;
-    static std::deque<PendingCommand>    pending_commands;
-    static std::mutex                    commands_mutex;
+    Keymap                               keymap {};
 
     template<typename Pred>
     bool bubble_up(Pred const &predicate)
@@ -434,18 +474,15 @@ public:
         return (Rectangle) { .x = viewport.x + l, .y = viewport.y + t, .width = w, .height = h };
     }
 
-    void submit(std::string_view const &command, JSONValue const &args)
+    // Commands are added when a widget is initialized and never removed, so
+    // this can be called from any thread.
+    [[nodiscard]] bool has_command(std::string_view const &command) const
     {
-        auto lg = std::lock_guard(commands_mutex);
-        auto name = std::string { command };
-        trace(CMD, "Submitting {}::{}({})", typeid(this).name(), name, args.serialize());
-        if (!commands.contains(name)) {
-            return;
-        }
-        auto const &cmd = commands.at(name);
-        pending_commands.emplace_back(cmd, args);
+        return commands.contains(std::string { command });
     }
 
+    void submit(std::string_view const &command, JSONValue const &args, TaskPriority priority = TaskPriority::Normal);
+
     [[nodiscard]] bool                    contains(Vector2 world_coordinates) const;
     [[nodiscard]] std::optional<Vec<int>> coordinates(Vector2 world_coordinates) const;
 
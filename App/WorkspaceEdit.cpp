@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <App/Aragorn.h>
+#include <App/Buffer.h>
+#include <App/WorkspaceEdit.h>
+
+namespace Aragorn {
+
+static Decoded<std::vector<TextEdit>> decode_edits(JSONValue const &edits)
+{
+    if (!edits.is_array()) {
+        return JSONError { JSONError::Code::TypeMismatch, "edits" };
+    }
+    std::vector<TextEdit> ret;
+    for (auto const &edit : edits) {
+        ret.push_back(TRY_EVAL(TextEdit::decode(edit)));
+    }
+    return ret;
+}
+
+Decoded<std::vector<FileEdits>> group_workspace_edit(JSONValue const &edit)
+{
+    std::vector<FileEdits>        ret;
+    std::map<std::string, size_t> files;
+    auto                          edits_for = [&ret, &files](std::string const &uri) -> std::vector<TextEdit> & {
+        auto [it, inserted] = files.try_emplace(uri, ret.size());
+        if (inserted) {
+            ret.emplace_back(uri, std::vector<TextEdit> {});
+        }
+        return ret[it->second].edits;
+    };
+    // documentChanges takes precedence over changes if a server sends both.
+    if (auto document_changes = edit.get("documentChanges"); document_changes && document_changes->is_array()) {
+        for (auto const &change : *document_changes) {
+            if (change.has("kind")) {
+                return JSONError { JSONError::Code::UnexpectedValue, "Resource operations are not supported" };
+            }
+            auto text_document = change.get("textDocument");
+            if (!text_document) {
+                return JSONError { JSONError::Code::MissingValue, "textDocument" };
+            }
+            auto uri = TRY_EVAL(text_document->try_get<std::string>("uri"));
+            auto edits = TRY_EVAL(decode_edits(change.get("edits").value_or(JSONValue {})));
+            std::ranges::move(edits, std::back_inserter(edits_for(uri)));
+        }
+        return ret;
+    }
+    if (auto changes = edit.get("changes"); changes && changes->is_object()) {
+        for (auto it = changes->obj_begin(); it != changes->obj_end(); ++it) {
+            auto edits = TRY_EVAL(decode_edits(it->second));
+            std::ranges::move(edits, std::back_inserter(edits_for(it->first)));
+        }
+    }
+    return ret;
+}
+
+static std::string uri_to_path(std::string_view const &uri)
+{
+    auto        path = uri.starts_with("file://") ? uri.substr(7) : uri;
+    std::string ret;
+    for (size_t ix = 0; ix < path.length(); ++ix) {
+        if (path[ix] == '%' && ix + 2 < path.length() && isxdigit(path[ix + 1]) && isxdigit(path[ix + 2])) {
+            ret += static_cast<char>(std::stoi(std::string { path.substr(ix + 1, 2) }, nullptr, 16));
+            ix += 2;
+        } else {
+            ret += path[ix];
+        }
+    }
+    return ret;
+}
+
+static Result<std::string> read_contents(std::string const &path)
+{
+    std::ifstream is(path, std::ios::binary);
+    if (!is) {
+        return LibCError();
+    }
+    std::ostringstream contents;
+    contents << is.rdbuf();
+    return contents.str();
+}
+
+// Writes the text to a temporary file next to path, which then replaces
+// path and takes over its permissions. A failure leaves the original file
+// as it was.
+template<typename Fn>
+static CError replace_file(std::string const &path, Fn const &write)
+{
+    auto tmp = path + ".aragorn-tmp";
+    {
+        std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+        if (!os) {
+            return LibCError();
+        }
+        write(os);
+        os.close();
+        if (os.fail()) {
+            std::filesystem::remove(tmp);
+            return LibCError("Could not write '{}'", tmp);
+        }
+    }
+    std::error_code ec;
+    if (auto status = std::filesystem::status(path, ec); !ec) {
+        std::filesystem::permissions(tmp, status.permissions(), ec);
+        if (ec) {
+            std::filesystem::remove(tmp);
+            return LibCError("Could not set the permissions of '{}': {}", tmp, ec.message());
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp);
+        return LibCError("Could not replace '{}': {}", path, ec.message());
+    }
+    return {};
+}
+
+// LSP positions count characters in UTF-16 code units.
+static CError rewrite_file(std::string const &path, std::vector<TextEdit> const &edits, std::string &original)
+{
+    original = TRY_EVAL(read_contents(path));
+    std::vector<size_t> line_starts { 0 };
+    for (size_t ix = 0; ix < original.length(); ++ix) {
+        if (original[ix] == '\n') {
+            line_starts.push_back(ix + 1);
+        }
+    }
+    auto offset_of = [&original, &line_starts](LSP::Position const &pos) -> size_t {
+        if (pos.line >= line_starts.size()) {
+            return original.length();
+        }
+        auto at = line_starts[pos.line];
+        auto end = (pos.line + 1 < line_starts.size()) ? line_starts[pos.line + 1] - 1 : original.length();
+        for (size_t units = 0; units < pos.character && at < end;) {
+            auto ch = static_cast<unsigned char>(original[at]);
+            auto len = (ch < 0x80) ? 1 : ((ch >> 5) == 0x06) ? 2 : ((ch >> 4) == 0x0E) ? 3 : 4;
+            units += (len == 4) ? 2 : 1;
+            at += len;
+        }
+        return std::min(at, end);
+    };
+    struct Edit {
+        size_t             start;
+        size_t             end;
+        std::string const *text;
+    };
+    std::vector<Edit> resolved;
+    resolved.reserve(edits.size());
+    for (auto const &edit : edits) {
+        auto start = offset_of(edit.range.start);
+        resolved.emplace_back(start, std::max(start, offset_of(edit.range.end)), &edit.newText);
+    }
+    std::ranges::stable_sort(resolved, {}, &Edit::start);
+    for (size_t ix = 1; ix < resolved.size(); ++ix) {
+        if (resolved[ix].start < resolved[ix - 1].end) {
+            return LibCError("Overlapping text edits at offset {} in '{}'", resolved[ix].start, path);
+        }
+    }
+    return replace_file(path, [&original, &resolved](std::ofstream &os) {
+        size_t at = 0;
+        for (auto const &edit : resolved) {
+            os.write(original.data() + at, static_cast<std::streamsize>(edit.start - at));
+            os.write(edit.text->data(), static_cast<std::streamsize>(edit.text->length()));
+            at = edit.end;
+        }
+        os.write(original.data() + at, static_cast<std::streamsize>(original.length() - at));
+    });
+}
+
+WorkspaceEditor &WorkspaceEditor::the()
+{
+    static WorkspaceEditor s_editor;
+    return s_editor;
+}
+
+void WorkspaceEditor::apply(std::vector<FileEdits> files)
+{
+    if (busy()) {
+        Aragorn::set_message("A workspace edit is still in progress");
+        return;
+    }
+    m_jobs.clear();
+    m_buffers.clear();
+    m_undoable = false;
+    for (auto &file : files) {
+        auto path = uri_to_path(file.uri);
+        auto it = std::ranges::find_if(Aragorn::the()->buffers, [&path](pBuffer const &buffer) {
+            return !buffer->name.empty() && uri_to_path(buffer->uri()) == path;
+        });
+        if (it == Aragorn::the()->buffers.end()) {
+            m_jobs.emplace_back(std::move(path), std::move(file.edits));
+            continue;
+        }
+        auto const &buffer = *it;
+        auto        version = buffer->version.load();
+        if (auto err = buffer->apply_text_edits(file.edits); err.is_error()) {
+            Aragorn::set_message(std::format("{}: {}", buffer->name, err.error().description));
+            continue;
+        }
+        // Undoing an edit that changed nothing would undo an unrelated one.
+        if (buffer->version != version) {
+            m_buffers.emplace_back(buffer, buffer->version);
+        }
+    }
+    start("Editing", [](FileJob &job) -> CError {
+        TRY(rewrite_file(job.path, job.edits, job.original));
+        std::error_code ec;
+        job.written = std::filesystem::last_write_time(job.path, ec);
+        return {};
+    });
+}
+
+// Files changed on disk since the edit, and buffers edited since, are left
+// alone.
+void WorkspaceEditor::undo()
+{
+    if (busy()) {
+        Aragorn::set_message("A workspace edit is still in progress");
+        return;
+    }
+    if (!m_undoable) {
+        Aragorn::set_message("No workspace edit to undo");
+        return;
+    }
+    m_undoable = false;
+    std::erase_if(m_buffers, [](BufferChange const &change) {
+        auto buffer = change.buffer.lock();
+        if (buffer == nullptr || buffer->version != change.version) {
+            return true;
+        }
+        buffer->undo();
+        return false;
+    });
+    std::erase_if(m_jobs, [](FileJob const &job) { return job.error.has_value(); });
+    m_undoing = true;
+    start("Undoing", [](FileJob &job) -> CError {
+        std::error_code ec;
+        if (std::filesystem::last_write_time(job.path, ec) != job.written) {
+            return LibCError("'{}' was changed after the edit", job.path);
+        }
+        return replace_file(job.path, [&job](std::ofstream &os) {
+            os.write(job.original.data(), static_cast<std::streamsize>(job.original.length()));
+        });
+    });
+}
+
+void WorkspaceEditor::start(std::string_view const &verb, Work const &work)
+{
+    m_verb = verb;
+    m_next = 0;
+    m_done = 0;
+    if (m_jobs.empty()) {
+        poll();
+        return;
+    }
+    auto count = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), m_jobs.size());
+    for (size_t ix = 0; ix < count; ++ix) {
+        m_workers.emplace_back([this, work]() {
+            for (auto job = m_next++; job < m_jobs.size(); job = m_next++) {
+                if (auto err = work(m_jobs[job]); err.is_error()) {
+                    m_jobs[job].error = err.error().description;
+                }
+                ++m_done;
+            }
+        });
+    }
+}
+
+// Called every frame. Once all files are done, the workers are joined and
+// the outcome is reported.
+void WorkspaceEditor::poll()
+{
+    if (m_done < m_jobs.size()) {
+        return;
+    }
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    if (m_verb.empty()) {
+        return;
+    }
+    auto failed = std::ranges::count_if(m_jobs, [](FileJob const &job) { return job.error.has_value(); });
+    for (auto const &job : m_jobs) {
+        if (job.error) {
+            trace(EDIT, "{}: {}", job.path, *job.error);
+        }
+    }
+    auto files = m_jobs.size() + m_buffers.size();
+    if (m_undoing) {
+        Aragorn::set_message(std::format("Undid workspace edit in {} files", files - failed));
+        m_jobs.clear();
+        m_buffers.clear();
+        m_undoing = false;
+    } else {
+        m_undoable = true;
+        if (failed > 0) {
+            Aragorn::set_message(std::format("Edited {} files, {} failed", files - failed, failed));
+        } else {
+            Aragorn::set_message(std::format("Edited {} files", files));
+        }
+    }
+    m_verb.clear();
+}
+
+std::string WorkspaceEditor::progress() const
+{
+    if (!busy()) {
+        return {};
+    }
+    return std::format("{} {}/{} files", m_verb, m_done.load(), m_jobs.size());
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <LibCore/JSON.h>
+#include <LibCore/Result.h>
+#include <LSP/Schema/TextEdit.h>
+
+namespace Aragorn {
+
+using namespace LibCore;
+using namespace LSP;
+
+struct Buffer;
+
+// The text edits a WorkspaceEdit makes to one file.
+struct FileEdits {
+    std::string           uri;
+    std::vector<TextEdit> edits;
+};
+
+// Groups the edits of a WorkspaceEdit per file. Both the changes map and
+// documentChanges made of TextDocumentEdits are accepted. Creating,
+// renaming and deleting files is not supported.
+Decoded<std::vector<FileEdits>> group_workspace_edit(JSONValue const &edit);
+
+// Applies workspace edits such as renames across a project. Files that are
+// open are edited in their buffer, as a single change each. Other files are
+// rewritten on disk by a pool of worker threads, each file by one thread:
+// the new contents are streamed to a temporary file which then replaces the
+// original. Progress is shown in the status bar. The last workspace edit
+// can be undone as a whole.
+class WorkspaceEditor {
+public:
+    static WorkspaceEditor &the();
+
+    void                      apply(std::vector<FileEdits> files);
+    void                      undo();
+    void                      poll();
+    [[nodiscard]] bool        busy() const { return !m_workers.empty(); }
+    [[nodiscard]] std::string progress() const;
+
+private:
+    struct FileJob {
+        std::string                     path;
+        std::vector<TextEdit>           edits;
+        std::string                     original {};
+        std::filesystem::file_time_type written {};
+        std::optional<std::string>      error {};
+    };
+
+    struct BufferChange {
+        std::weak_ptr<Buffer> buffer;
+        size_t                version;
+    };
+
+    using Work = std::function<CError(FileJob &)>;
+
+    WorkspaceEditor() = default;
+    void start(std::string_view const &verb, Work const &work);
+
+    std::vector<FileJob>      m_jobs {};
+    std::vector<BufferChange> m_buffers {};
+    std::vector<std::thread>  m_workers {};
+    std::atomic<size_t>       m_next { 0 };
+    std::atomic<size_t>       m_done { 0 };
+    std::string               m_verb {};
+    bool                      m_undoing { false };
+    bool                      m_undoable { false };
+};
+
+}
@@ -29,6 +29,17 @@ JSONValue Notification::encode() const
     return ret;
 }
 
+void Notification::serialize(JSONWriter &writer) const
+{
+    writer.begin_object();
+    writer.key("jsonrpc").value("2.0");
+    writer.key("method").value(method);
+    if (params) {
+        writer.key("params").write(*params);
+    }
+    writer.end_object();
+}
+
 Decoded<Notification> Notification::decode(JSONValue const &json)
 {
     Notification ret {};
@@ -38,6 +49,19 @@ Decoded<Notification> Notification::decode(JSONValue const &json)
     return ret;
 }
 
+Decoded<ServerConfig> ServerConfig::decode(JSONValue const &json)
+{
+    ServerConfig ret {};
+
+    ret.name = TRY_EVAL(json.try_get<std::string>("name"));
+    TRY(json.get("command").value_or(JSONValue { ret.name }).convert<std::string>(ret.command));
+    TRY(json.get("args").value_or(JSONValue { JSONType::Array }).convert(ret.args));
+    ret.languages = TRY_EVAL(json.try_get_array<std::string>("languages"));
+    TRY(json.get("prewarm").value_or(JSONValue { false }).convert<bool>(ret.prewarm));
+    TRY(json.get("record").value_or(JSONValue { "" }).convert<std::string>(ret.record));
+    return ret;
+}
+
 Decoded<Response> Response::decode(JSONValue const &json)
 {
     int      id = TRY_EVAL(json.try_get<int>("id"));
@@ -48,55 +72,150 @@ Decoded<Response> Response::decode(JSONValue const &json)
     return ret;
 }
 
-CError LSP::message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params)
+CError LSP::message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params, RequestOptions options)
 {
-    if (!m_ready) {
-        std::unique_lock lk(mutex);
-        Defer            sg { [&lk] { lk.unlock(); } };
-        init_condition.wait(lk, [this]() { return m_ready; });
-    }
-    return private_message(sender, method, params);
+    return private_message(sender, method, params, std::move(options));
 }
 
-CError LSP::private_message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params)
+CError LSP::private_message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params, RequestOptions options)
 {
     Request req;
     req.sender = sender;
     req.method = method;
-    req.params = params;
-    log->insert(log->length(), std::format("Sending LSP message: {} ({})...\n", method, req.id));
-    request_queue.push_back(req);
-    auto encoded { req.encode() };
-    auto json { encoded.serialize() };
-    auto content_length = std::format("Content-Length: {}\r\n\r\n", json.length() + 2);
-    TRY(lsp->write_to(content_length));
-    TRY(lsp->write_to(json));
-    TRY(lsp->write_to("\r\n"));
+    req.params = std::move(params);
+    req.response_format = options.format;
+    req.key = std::move(options.key);
+    req.is_current = std::move(options.is_current);
+    req.on_response = std::move(options.on_response);
+    auto now = Clock::now();
+    req.sent = now;
+    if (options.timeout) {
+        req.deadline = now + *options.timeout;
+    }
+    log->append(std::format("Sending LSP message: {} ({})...\n", method, req.id));
+
+    std::vector<Request> superseded;
+    std::vector<Request> expired;
+    {
+        std::lock_guard lock(m_pending_mutex);
+        expire_requests(now, expired);
+        if (!req.key.empty()) {
+            if (auto [it, inserted] = m_pending_by_key.try_emplace(req.key, req.id); !inserted) {
+                if (auto node = m_pending.extract(it->second); !node.empty()) {
+                    superseded.push_back(std::move(node.mapped()));
+                }
+                it->second = req.id;
+            }
+        }
+        if (req.deadline) {
+            m_next_deadline = std::min(m_next_deadline, *req.deadline);
+        }
+        m_pending.emplace(req.id, req);
+    }
+    TRY(abandon(expired, "timed out"));
+    TRY(abandon(superseded, "was superseded"));
+
+    std::string body;
+    JSONWriter  writer { body };
+    req.serialize(writer);
+    if (auto err = write(std::move(body), MessageWriter::Priority::Normal, req.id); err.is_error()) {
+        std::lock_guard lock(m_pending_mutex);
+        m_pending.erase(req.id);
+        if (auto it = m_pending_by_key.find(req.key); it != m_pending_by_key.end() && it->second == req.id) {
+            m_pending_by_key.erase(it);
+        }
+        return err;
+    }
     return {};
 }
 
-CError LSP::notification(std::string_view method, std::optional<JSONValue> params)
+// Must be called with m_pending_mutex held. Expired requests are removed
+// and moved to expired, to be abandoned once the lock is released.
+void LSP::expire_requests(Clock::time_point now, std::vector<Request> &expired)
 {
-    if (!m_ready) {
-        std::unique_lock lk(mutex);
-        Defer            defer { [&lk] { lk.unlock(); } };
-        init_condition.wait(lk, [this]() { return m_ready; });
+    if (now < m_next_deadline) {
+        return;
+    }
+    m_next_deadline = Clock::time_point::max();
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        auto &req = it->second;
+        if (!req.deadline) {
+            ++it;
+            continue;
+        }
+        if (*req.deadline <= now) {
+            if (!req.key.empty()) {
+                m_pending_by_key.erase(req.key);
+            }
+            expired.push_back(std::move(req));
+            it = m_pending.erase(it);
+            continue;
+        }
+        m_next_deadline = std::min(m_next_deadline, *req.deadline);
+        ++it;
     }
+}
+
+// Requests that are no longer pending. Whoever is waiting for a response is
+// told it isn't coming. A request that hasn't been written yet is withdrawn
+// without the server ever seeing it; otherwise the cancellation jumps the
+// queue.
+CError LSP::abandon(std::vector<Request> const &requests, std::string_view reason)
+{
+    for (auto const &req : requests) {
+        log->append(std::format("LSP request {} ({}) {}\n", req.id, req.method, reason));
+        if (req.on_response) {
+            req.on_response(JSONError { JSONError::Code::ProtocolError, std::format("Request '{}' {}", req.method, reason) });
+        }
+        {
+            std::lock_guard lock(mutex);
+            if (std::erase_if(m_deferred, [&req](auto const &deferred) { return deferred.request_id == req.id; }) > 0) {
+                continue;
+            }
+        }
+        if (m_writer.withdraw(req.id)) {
+            continue;
+        }
+        auto params = JSONValue::object();
+        params.set("id", JSONValue { req.id });
+        TRY(private_notification("$/cancelRequest", std::move(params), MessageWriter::Priority::High));
+    }
+    return {};
+}
+
+void LSP::on_notification(std::string const &method, NotificationHandler handler)
+{
+    std::lock_guard lock(mutex);
+    m_notification_handlers[method] = std::move(handler);
+}
+
+CError LSP::notification(std::string_view method, std::optional<JSONValue> params)
+{
     return private_notification(method, params);
 }
 
-CError LSP::private_notification(std::string_view method, std::optional<JSONValue> params)
+CError LSP::private_notification(std::string_view method, std::optional<JSONValue> params, MessageWriter::Priority priority)
 {
     Notification notification;
-    log->insert(log->length(), std::format("Sending LSP notification: {}...\n", method));
+    log->append(std::format("Sending LSP notification: {}...\n", method));
     notification.method = method;
-    notification.params = params;
-    auto json = notification.encode().serialize();
-    auto content_length = std::format("Content-Length: {}\r\n\r\n", json.length() + 2);
-    TRY(lsp->write_to(content_length));
-    TRY(lsp->write_to(json));
-    TRY(lsp->write_to("\r\n"));
-    return {};
+    notification.params = std::move(params);
+    std::string body;
+    JSONWriter  writer { body };
+    notification.serialize(writer);
+    return write(std::move(body), priority);
+}
+
+CError LSP::write(std::string body, MessageWriter::Priority priority, std::optional<int> request_id)
+{
+    {
+        std::lock_guard lock(mutex);
+        if (m_initializing) {
+            m_deferred.emplace_back(std::move(body), priority, request_id);
+            return {};
+        }
+    }
+    return m_writer.post(std::move(body), priority, request_id);
 }
 
 void handle_initialize_response(pWidget const &lsp, JSONValue const &response_json)
@@ -104,28 +223,42 @@ void handle_initialize_response(pWidget const &lsp, JSONValue const &response_js
     std::dynamic_pointer_cast<LSP>(lsp)->on_initialize_response(response_json);
 }
 
+// The initialized notification has to be the first thing the server gets
+// after its initialize response. Everything that was sent in the meantime
+// follows it, in order.
 void LSP::on_initialize_response(JSONValue const &response_json)
 {
     assert(!m_ready);
-    {
-        std::unique_lock lk(mutex);
-        Defer            sg { [&lk] { lk.unlock(); } };
-        auto             response = Response::decode(response_json);
-        assert(!response.is_error());
-        auto  result = make_response_result<InitializeResult>(response.value());
-        auto &res = result.value();
-        if (res.serverInfo) {
-            log->insert(log->length(), std::format("LSP server name: {}\n", res.serverInfo->name));
-            if (res.serverInfo->version) {
-                log->insert(log->length(), std::format("LSP server version: {}\n", *(res.serverInfo->version)));
-            }
+    std::lock_guard lock(mutex);
+    auto            response = Response::decode(response_json);
+    assert(!response.is_error());
+    auto  result = make_response_result<InitializeResult>(response.value());
+    auto &res = result.value();
+    if (res.serverInfo) {
+        log->append(std::format("LSP server name: {}\n", res.serverInfo->name));
+        if (res.serverInfo->version) {
+            log->append(std::format("LSP server version: {}\n", *(res.serverInfo->version)));
         }
-        server_capabilities = res.capabilities;
-        initialize_theme_internal();
-        MUST(private_notification("initialized"));
-        m_ready = true;
     }
-    init_condition.notify_all();
+    server_capabilities = res.capabilities;
+    // The theme is read while drawing, so it is updated on the main thread.
+    ::Aragorn::Aragorn::the()->post([lsp = self<LSP>()]() {
+        lsp->initialize_theme_internal();
+    });
+
+    Notification initialized;
+    initialized.method = "initialized";
+    std::string body;
+    JSONWriter  writer { body };
+    initialized.serialize(writer);
+    log->append("Sending LSP notification: initialized...\n");
+    MUST(m_writer.post(std::move(body)));
+    for (auto &deferred : m_deferred) {
+        MUST(m_writer.post(std::move(deferred.body), deferred.priority, deferred.request_id));
+    }
+    m_deferred.clear();
+    m_initializing = false;
+    m_ready = true;
 }
 
 void lsp_read(ReadPipe<LSP *> &pipe)
@@ -134,67 +267,142 @@ void lsp_read(ReadPipe<LSP *> &pipe)
     lsp->read(pipe);
 }
 
-void LSP::read(ReadPipe<LSP *> &pipe)
+// Only the envelope members needed for routing are decoded. The rest of
+// the message is turned into a JSONValue only if somebody handles it.
+void LSP::dispatch_notification(JSONTape::Ref const &message)
 {
-    read_buffer += pipe.current();
-    scanner.string = read_buffer;
-    scanner.mark = scanner.point = TextPosition {};
-    if (!scanner.expect("Content-Length:")) {
+    auto method_maybe = message.get("method")->as_string();
+    if (method_maybe.is_error()) {
+        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", method_maybe.error().description));
         return;
     }
-    scanner.skip_whitespace();
-    size_t resp_content_length = scanner.read_number();
-    if (!resp_content_length) {
+    log->append(std::format("Received notification '{}'\n", method_maybe.value()));
+    NotificationHandler handler;
+    {
+        std::lock_guard lock(mutex);
+        if (auto it = m_notification_handlers.find(method_maybe.value()); it != m_notification_handlers.end()) {
+            handler = it->second;
+        }
+    }
+    if (handler) {
+        handler(message.text());
         return;
     }
-    if (!scanner.expect("\r\n\r\n")) {
+    auto command = std::format("lsp-{}", method_maybe.value());
+    if (!has_command(command)) {
         return;
     }
-    auto response_json = scanner.read(resp_content_length);
-    if (response_json.length() < resp_content_length) {
+    auto value_maybe = message.to_value();
+    if (value_maybe.is_error()) {
+        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", value_maybe.error().description));
         return;
     }
-    auto ret_maybe = JSONValue::deserialize(response_json);
-    read_buffer.clear();
-    if (ret_maybe.is_error()) {
-        std::println("ERROR Parsing incoming JSON: {}", ret_maybe.error().description);
-        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", ret_maybe.error().description));
+    submit(command, value_maybe.value(), TaskPriority::Background);
+}
+
+void LSP::dispatch_response(JSONTape::Ref const &message)
+{
+    auto id_ref = message.get("id");
+    if (!id_ref) {
+        ::Aragorn::Aragorn::the()->set_message("LSP: Message has neither an id nor a method");
         return;
     }
-    JSONValue const &ret = ret_maybe.value();
-    if (ret.has("id")) {
-        auto response_maybe = Response::decode(ret);
-        if (response_maybe.is_error()) {
-            ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", response_maybe.error().description));
+    auto id_maybe = id_ref->as_integer();
+    if (id_maybe.is_error()) {
+        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", id_maybe.error().description));
+        return;
+    }
+    Request req { static_cast<int>(id_maybe.value()) };
+    {
+        std::lock_guard lock(m_pending_mutex);
+        auto            node = m_pending.extract(req.id);
+        if (node.empty()) {
+            // Cancelled, superseded or timed out. The body is never decoded.
+            log->append(std::format("Dropped response id {} which was not pending\n", req.id));
             return;
         }
-
-        log->insert(log->length(), std::format("Received response id {}", response_maybe.value().id));
-        auto const &response = response_maybe.value();
-        for (auto ix = 0; ix < request_queue.size(); ++ix) {
-            Request const &req = request_queue[ix];
-            log->insert(log->length(), std::format(" for request '{}'\n", req.method));
-            if (req.id == response.id) {
-                if (req.method == "initialize") {
-                    handle_initialize_response(req.sender, ret);
-                } else {
-                    req.sender->submit(std::format("lsp-{}", req.method), ret);
-                }
-                request_queue.erase(request_queue.begin() + ix);
-                return;
+        req = std::move(node.mapped());
+        statistics.add_latency(Clock::now() - req.sent);
+        if (!req.key.empty()) {
+            if (auto it = m_pending_by_key.find(req.key); it != m_pending_by_key.end() && it->second == req.id) {
+                m_pending_by_key.erase(it);
             }
         }
-        log->insert(log->length(), " which was not pending\n");
+    }
+    if (req.is_current && !req.is_current()) {
+        log->append(std::format("Dropped stale response id {} for request '{}'\n", req.id, req.method));
+        if (req.on_response) {
+            req.on_response(JSONError { JSONError::Code::ProtocolError, std::format("Response to '{}' is stale", req.method) });
+        }
+        return;
+    }
+    log->append(std::format("Received response id {} for request '{}'\n", req.id, req.method));
+    if (req.on_response) {
+        req.on_response(message.text());
+        return;
+    }
+
+    auto command = std::format("lsp-{}", req.method);
+    if (req.method != "initialize" && !req.sender->has_command(command)) {
+        return;
+    }
+    if (req.response_format == ResponseFormat::Text) {
+        req.sender->submit(command, JSONValue { message.text() }, TaskPriority::Background);
+        return;
+    }
+    auto value_maybe = message.to_value();
+    if (value_maybe.is_error()) {
+        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", value_maybe.error().description));
         return;
     }
-    assert(ret.has("method"));
-    log->insert(log->length(), std::format("Received notification '{}'", ret["method"].to_string()));
-    auto notification_maybe = Notification::decode(ret);
-    if (notification_maybe.is_error()) {
-        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", notification_maybe.error().description));
+    if (req.method == "initialize") {
+        handle_initialize_response(req.sender, value_maybe.value());
+        return;
+    }
+    req.sender->submit(command, value_maybe.value(), TaskPriority::Background);
+}
+
+void LSP::read(ReadPipe<LSP *> &pipe)
+{
+    std::vector<Request> expired;
+    {
+        std::lock_guard lock(m_pending_mutex);
+        expire_requests(Clock::now(), expired);
+    }
+    if (auto err = abandon(expired, "timed out"); err.is_error()) {
+        std::println("ERROR Cancelling LSP requests: {}", err.error().to_string());
+    }
+    framer.feed(pipe.current());
+    while (true) {
+        auto message_maybe = framer.next();
+        if (message_maybe.is_error()) {
+            std::println("ERROR Reading LSP message: {}", message_maybe.error().description);
+            ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", message_maybe.error().description));
+            continue;
+        }
+        if (!message_maybe.value()) {
+            break;
+        }
+        if (m_recorder.is_open()) {
+            m_recorder.record(Direction::ServerToClient, *message_maybe.value());
+        }
+        dispatch(*message_maybe.value());
+    }
+}
+
+void LSP::dispatch(std::string_view const &message)
+{
+    auto err = tape.index(message);
+    if (err.is_error()) {
+        std::println("ERROR Parsing incoming JSON: {}", err.error().description);
+        ::Aragorn::Aragorn::the()->set_message(std::format("LSP: {}", err.error().description));
         return;
     }
-    submit(std::format("lsp-{}", notification_maybe.value().method), ret);
+    if (auto root = tape.root(); root.has("method")) {
+        dispatch_notification(root);
+    } else {
+        dispatch_response(root);
+    }
 }
 
 void LSP::initialize_theme_internal()
@@ -218,6 +426,30 @@ void LSP::initialize_theme()
     initialize_theme_internal();
 }
 
+bool LSP::supports_semantic_tokens_delta() const
+{
+    if (!m_ready || !server_capabilities.semanticTokensProvider) {
+        return false;
+    }
+    auto const &full = server_capabilities.semanticTokensProvider->full;
+    if (!full || !std::holds_alternative<SemanticTokensOptions::Full_1>(*full)) {
+        return false;
+    }
+    return std::get<SemanticTokensOptions::Full_1>(*full).delta.value_or(false);
+}
+
+bool LSP::supports_semantic_tokens_range() const
+{
+    if (!m_ready || !server_capabilities.semanticTokensProvider) {
+        return false;
+    }
+    auto const &range = server_capabilities.semanticTokensProvider->range;
+    if (!range) {
+        return false;
+    }
+    return !std::holds_alternative<bool>(*range) || std::get<bool>(*range);
+}
+
 void LSP::initialize()
 {
     if (m_ready) {
@@ -228,13 +460,19 @@ void LSP::initialize()
         return;
     }
 
-    log = ::Aragorn::Aragorn::the()->create_system_buffer("LSP Log");
+    log = ::Aragorn::Aragorn::the()->create_system_buffer(std::format("LSP Log ({})", config.name));
 
-    lsp.emplace("clangd", "--use-dirty-headers", "--background-index");
-    lsp->stderr_file = "/tmp/clangd.log";
+    lsp.emplace(config.command, config.args);
+    lsp->stderr_file = std::format("/tmp/{}.log", config.name);
     lsp->on_stdout_read(lsp_read);
-    std::println("Starting LSP");
+    std::println("Starting LSP server '{}'", config.name);
+    if (!config.record.empty()) {
+        if (auto err = m_recorder.open(config.record); err.is_error()) {
+            log->append(std::format("Could not open LSP recording '{}': {}\n", config.record, err.error().description));
+        }
+    }
     MUST(lsp->background(this));
+    MUST(m_writer.start(lsp->stdin_fd(), m_recorder.is_open() ? &m_recorder : nullptr));
 
     InitializeParams params;
     params.processId.emplace<int>(getpid());
@@ -249,7 +487,8 @@ void LSP::initialize()
     SemanticTokensClientCapabilities semanticTokensClientCapabilities;
     semanticTokensClientCapabilities.multilineTokenSupport = true;
     semanticTokensClientCapabilities.requests = SemanticTokensClientCapabilities::Requests {};
-    semanticTokensClientCapabilities.requests.full.emplace<bool>(true);
+    semanticTokensClientCapabilities.requests.full.emplace(SemanticTokensClientCapabilities::Requests::Full_1 { .delta = true });
+    semanticTokensClientCapabilities.requests.range.emplace<bool>(true);
     semanticTokensClientCapabilities.tokenTypes.emplace_back(SemanticTokenTypes_as_string(SemanticTokenTypes::Comment));
     semanticTokensClientCapabilities.tokenTypes.emplace_back(SemanticTokenTypes_as_string(SemanticTokenTypes::Keyword));
     semanticTokensClientCapabilities.tokenTypes.emplace_back(SemanticTokenTypes_as_string(SemanticTokenTypes::Variable));
@@ -259,7 +498,28 @@ void LSP::initialize()
     params.capabilities.textDocument->synchronization = syncCapabilities;
     params.capabilities.textDocument->semanticTokens = semanticTokensClientCapabilities;
 
-    MUST(private_message(self(), "initialize", params.encode()));
+    MUST(private_message(self(), "initialize", params.encode(), RequestOptions { .timeout = {} }));
+    std::lock_guard lock(mutex);
+    if (!m_ready) {
+        m_initializing = true;
+    }
+}
+
+// The process is left to exit by itself once the server has seen the exit
+// notification. The reading thread keeps a pointer to this object, so it
+// has to stay alive until finished() says the server's output has been read
+// to the end.
+Task<> LSP::shutdown()
+{
+    if (!lsp) {
+        co_return;
+    }
+    auto result = co_await request<JSONValue>("shutdown", RequestOptions { .timeout = std::chrono::seconds { 5 } });
+    if (result.is_error()) {
+        trace(LSP, "shutdown '{}': {}", config.name, result.error().description);
+    }
+    IGNORE(notification("exit", {}));
+    m_ready = false;
 }
 
 }
@@ -6,14 +6,27 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <functional>
+#include <unordered_map>
+
 #include <App/Aragorn.h>
 #include <App/Widget.h>
+#include <LSP/MessageFramer.h>
+#include <LSP/MessageWriter.h>
+#include <LSP/Recorder.h>
 #include <LSP/Schema/CompletionItem.h>
 #include <LSP/Schema/ServerCapabilities.h>
+#include <LSP/Statistics.h>
 #include <LibCore/JSON.h>
+#include <LibCore/JSONReader.h>
+#include <LibCore/JSONTape.h>
+#include <LibCore/JSONWriter.h>
 #include <LibCore/Lexer.h>
 #include <LibCore/Process.h>
-#include <LibCore/StringScanner.h>
+#include <LibCore/Task.h>
 
 namespace LSP {
 
@@ -27,6 +40,7 @@ struct Notification {
     Notification() = default;
 
     JSONValue                    encode() const;
+    void                         serialize(JSONWriter &writer) const;
     static Decoded<Notification> decode(JSONValue const &value);
 };
 
@@ -36,12 +50,47 @@ Decoded<MethodParams> make_notification_params(Notification const &notification)
     return MethodParams::decode(*notification.params);
 }
 
+// Text: the response is submitted to the sender as the raw message text,
+// to be decoded with read_response_result() without building a JSONValue.
+enum class ResponseFormat {
+    Value,
+    Text,
+};
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto DefaultRequestTimeout = std::chrono::seconds { 30 };
+
+using ResponseHandler = std::function<void(Decoded<std::string_view> const &)>;
+
+struct RequestOptions {
+    ResponseFormat                           format { ResponseFormat::Value };
+    std::optional<std::chrono::milliseconds> timeout { DefaultRequestTimeout };
+    // A new request with the same non-empty key supersedes a pending one,
+    // which is then cancelled.
+    std::string key {};
+    // Called before the response is handed to the sender. Returning false
+    // drops the response undecoded, for example because the document it
+    // was requested for has changed since.
+    std::function<bool()> is_current {};
+    // If set, the response text is passed here, on the thread reading from
+    // the server, instead of being submitted to the sender. Requests that
+    // are dropped, superseded or time out get an error instead.
+    ResponseHandler on_response {};
+};
+
 struct Request {
-    static int               next_id;
-    pWidget                  sender { nullptr };
-    int                      id;
-    std::string              method;
-    std::optional<JSONValue> params;
+    static int                       next_id;
+    pWidget                          sender { nullptr };
+    int                              id;
+    std::string                      method;
+    std::optional<JSONValue>         params;
+    ResponseFormat                   response_format { ResponseFormat::Value };
+    std::string                      key {};
+    std::optional<Clock::time_point> deadline {};
+    Clock::time_point                sent {};
+    std::function<bool()>            is_current {};
+    ResponseHandler                  on_response {};
 
     Request()
         : id(next_id++)
@@ -64,6 +113,18 @@ struct Request {
         }
         return ret;
     }
+
+    void serialize(JSONWriter &writer) const
+    {
+        writer.begin_object();
+        writer.key("jsonrpc").value("2.0");
+        writer.key("id").value(id);
+        writer.key("method").value(method);
+        if (params) {
+            writer.key("params").write(*params);
+        }
+        writer.end_object();
+    }
 };
 
 template<typename MethodParams>
@@ -78,7 +139,7 @@ Request make_request(pWidget const &sender, std::string_view method, std::option
     return req;
 }
 
-using Requests = std::vector<Request>;
+using Requests = std::unordered_map<int, Request>;
 
 struct Response {
     int                      id;
@@ -105,8 +166,62 @@ Decoded<MethodParams> make_response_result(Response const &response)
     return MethodParams::decode(*response.result);
 }
 
+template<typename MethodResult>
+Decoded<MethodResult> read_response_result(std::string_view const &message)
+{
+    JSONReader                  reader { message };
+    bool                        has_result { false };
+    std::optional<MethodResult> result;
+    std::optional<JSONValue>    error;
+    TRY(reader.read_object([&reader, &has_result, &result, &error](std::string_view const &key) -> EJSON {
+        if (key == "result") {
+            has_result = true;
+            return read_json(reader, result);
+        }
+        if (key == "error") {
+            return read_json(reader, error);
+        }
+        return reader.skip();
+    }));
+    TRY(reader.expect_end());
+    if (!has_result || error) {
+        return JSONError { JSONError::Code::ProtocolError, "Response returned error" };
+    }
+    // "result": null is a successful response without a value.
+    return std::move(result).value_or(MethodResult {});
+}
+
+// Decodes the params of a notification straight from the message text. The
+// params are decoded into the argument so large ones aren't copied.
+template<typename MethodParams>
+EJSON read_notification_params(std::string_view const &message, MethodParams &params)
+{
+    JSONReader reader { message };
+    bool       has_params { false };
+    TRY(reader.read_object([&reader, &params, &has_params](std::string_view const &key) -> EJSON {
+        if (key == "params") {
+            has_params = true;
+            return MethodParams::read(reader, params);
+        }
+        return reader.skip();
+    }));
+    TRY(reader.expect_end());
+    if (!has_params) {
+        return JSONError { JSONError::Code::MissingValue, "params" };
+    }
+    return {};
+}
+
+// Called on the thread reading from the server with the text of the
+// notification.
+using NotificationHandler = std::function<void(std::string_view const &)>;
+using NotificationHandlers = std::unordered_map<std::string, NotificationHandler>;
+
 struct LSP;
 
+template<typename MethodResult>
+class RequestAwaitable;
+
 typedef struct mode *(*LSPInitMode)(LSP *);
 
 struct LSPHandler {
@@ -114,37 +229,146 @@ struct LSPHandler {
 };
 
 using LSPHandlers = std::vector<LSPHandler>;
-using LSPScanner = StringScanner<char>;
 
+// A language server as configured in the "lsp" section of settings.json.
+struct ServerConfig {
+    std::string name;
+    std::string command;
+    StringList  args {};
+    StringList  languages {};
+    bool        prewarm { false };
+    // If set, all traffic with the server is recorded to this file.
+    std::string record {};
+
+    static Decoded<ServerConfig> decode(JSONValue const &json);
+};
+
+// Messages sent before the server has answered the initialize request are
+// held back, and written in order once it has.
 struct LSP : Widget {
     LSPHandlers                   handlers;
     std::mutex                    mutex;
-    std::condition_variable       init_condition;
     std::optional<Process<LSP *>> lsp;
     ServerCapabilities            server_capabilities;
-    Requests                      request_queue;
-    std::string                   read_buffer;
-    LSPScanner                    scanner;
-    pBuffer                       log;
+    MessageFramer                 framer;
+    JSONTape                      tape;
+    pLogBuffer                    log;
+    ServerConfig                  config;
+    RequestStatistics             statistics;
 
-    LSP()
+    explicit LSP(ServerConfig config)
         : Widget(::Aragorn::Aragorn::the())
+        , config(std::move(config))
     {
     }
 
     void   initialize() override;
     CError notification(std::string_view method, std::optional<JSONValue> params);
-    CError message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params);
+    CError message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params, RequestOptions options = {});
+
+    // Sends a request and suspends the calling coroutine until the result
+    // has been decoded. The coroutine is resumed on the main thread.
+    template<typename MethodResult, typename MethodParams>
+    RequestAwaitable<MethodResult> request(std::string_view method, MethodParams const &params, RequestOptions options = {})
+    {
+        return RequestAwaitable<MethodResult> { *this, method, params.encode(), std::move(options) };
+    }
+
+    template<typename MethodResult>
+    RequestAwaitable<MethodResult> request(std::string_view method, RequestOptions options = {})
+    {
+        return RequestAwaitable<MethodResult> { *this, method, {}, std::move(options) };
+    }
+
+    Task<> shutdown();
+    bool   finished() const { return !lsp || lsp->finished(); }
+    void   stop() { m_writer.stop(); }
+    void   on_notification(std::string const &method, NotificationHandler handler);
+
     void   initialize_theme();
+    bool   supports_semantic_tokens_delta() const;
+    bool   supports_semantic_tokens_range() const;
+    bool   congested() const { return m_writer.congested(); }
+    bool   ready() const { return m_ready; }
     void   read(ReadPipe<LSP *> &pipe);
     void   on_initialize_response(JSONValue const &response_json);
 
 private:
     void   initialize_theme_internal();
-    CError private_message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params = {});
-    CError private_notification(std::string_view method, std::optional<JSONValue> params = {});
+    CError private_message(pWidget const &sender, std::string_view method, std::optional<JSONValue> params = {}, RequestOptions options = {});
+    CError abandon(std::vector<Request> const &requests, std::string_view reason);
+    void   expire_requests(Clock::time_point now, std::vector<Request> &expired);
+    CError write(std::string body, MessageWriter::Priority priority = MessageWriter::Priority::Normal, std::optional<int> request_id = {});
+    void   dispatch(std::string_view const &message);
+    void   dispatch_notification(JSONTape::Ref const &message);
+    void   dispatch_response(JSONTape::Ref const &message);
+    CError private_notification(std::string_view method, std::optional<JSONValue> params = {}, MessageWriter::Priority priority = MessageWriter::Priority::Normal);
+
+    struct Deferred {
+        std::string             body;
+        MessageWriter::Priority priority;
+        std::optional<int>      request_id;
+    };
+
+    std::atomic<bool>                    m_ready { false };
+    bool                                 m_initializing { false };
+    std::vector<Deferred>                m_deferred;
+    NotificationHandlers                 m_notification_handlers;
+    MessageWriter                        m_writer;
+    Recorder                             m_recorder;
+    std::mutex                           m_pending_mutex;
+    Requests                             m_pending;
+    std::unordered_map<std::string, int> m_pending_by_key;
+    Clock::time_point                    m_next_deadline { Clock::time_point::max() };
+};
 
-    bool m_ready { false };
+template<typename MethodResult>
+class RequestAwaitable {
+public:
+    RequestAwaitable(LSP &lsp, std::string_view method, std::optional<JSONValue> params, RequestOptions options)
+        : m_lsp(lsp)
+        , m_method(method)
+        , m_params(std::move(params))
+        , m_options(std::move(options))
+    {
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    // The response is decoded on the reading thread, and the coroutine is
+    // then posted to the main thread. If the request can't be sent the
+    // coroutine continues right away with the error.
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+        m_options.on_response = [this, handle](Decoded<std::string_view> const &message) {
+            if (message.is_error()) {
+                m_result.emplace(message.error());
+            } else {
+                auto start = Clock::now();
+                m_result.emplace(read_response_result<MethodResult>(message.value()));
+                m_lsp.statistics.add_decode_time(Clock::now() - start);
+            }
+            ::Aragorn::Aragorn::the()->post([handle]() { handle.resume(); });
+        };
+        if (auto err = m_lsp.message(nullptr, m_method, std::move(m_params), std::move(m_options)); err.is_error()) {
+            m_result.emplace(JSONError { JSONError::Code::ProtocolError, err.error().description });
+            return false;
+        }
+        return true;
+    }
+
+    Decoded<MethodResult> await_resume()
+    {
+        assert(m_result.has_value());
+        return std::move(*m_result);
+    }
+
+private:
+    LSP                                  &m_lsp;
+    std::string                           m_method;
+    std::optional<JSONValue>              m_params;
+    RequestOptions                        m_options;
+    std::optional<Decoded<MethodResult>> m_result {};
 };
 
 template<typename MethodParams>
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+
+#include <LSP/MessageFramer.h>
+
+namespace LSP {
+
+using namespace std::literals;
+
+static bool equals_ignore_case(std::string_view const &s1, std::string_view const &s2)
+{
+    return std::ranges::equal(s1, s2, [](char c1, char c2) {
+        return std::tolower(static_cast<unsigned char>(c1)) == std::tolower(static_cast<unsigned char>(c2));
+    });
+}
+
+static Result<size_t, JSONError> parse_header(std::string_view header)
+{
+    std::optional<size_t> content_length;
+    while (!header.empty()) {
+        auto eol = header.find("\r\n"sv);
+        auto line = header.substr(0, eol);
+        header = (eol == std::string_view::npos) ? std::string_view {} : header.substr(eol + 2);
+        auto colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            return JSONError { JSONError::Code::ProtocolError, std::format("Malformed LSP header line '{}'", line) };
+        }
+        if (!equals_ignore_case(line.substr(0, colon), "Content-Length"sv)) {
+            continue;
+        }
+        auto value = line.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ') {
+            value.remove_prefix(1);
+        }
+        size_t length;
+        auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.length(), length);
+        if (ec != std::errc {} || value.empty()) {
+            return JSONError { JSONError::Code::ProtocolError, std::format("Invalid Content-Length '{}'", value) };
+        }
+        content_length = length;
+    }
+    if (!content_length) {
+        return JSONError { JSONError::Code::ProtocolError, "LSP message header has no Content-Length" };
+    }
+    return *content_length;
+}
+
+void MessageFramer::feed(std::string_view const &data)
+{
+    // Everything before m_start has been handed out already. Dropping it
+    // when it makes up more than half of the buffer keeps the cost of the
+    // moves proportional to the amount of data read.
+    if (m_start == m_buffer.length()) {
+        m_buffer.clear();
+        m_scanned = m_start = 0;
+    } else if (m_start > m_buffer.length() / 2) {
+        m_buffer.erase(0, m_start);
+        m_scanned -= m_start;
+        m_start = 0;
+    }
+    m_buffer.append(data);
+}
+
+Result<std::optional<std::string_view>, JSONError> MessageFramer::next()
+{
+    if (!m_body_length) {
+        auto end = m_buffer.find("\r\n\r\n"sv, std::max(m_scanned, m_start));
+        if (end == std::string::npos) {
+            // The terminator can straddle the end of what has been read, so
+            // the last three bytes are searched again next time.
+            m_scanned = std::max(m_start, (m_buffer.length() >= 3) ? m_buffer.length() - 3 : 0);
+            if (buffered() > MaxHeaderSize) {
+                m_scanned = m_start = m_buffer.length();
+                return JSONError { JSONError::Code::ProtocolError, "LSP message header too long" };
+            }
+            return std::optional<std::string_view> {};
+        }
+        std::string_view header { m_buffer.data() + m_start, end - m_start };
+        m_scanned = m_start = end + 4;
+        m_body_length = TRY_EVAL(parse_header(header));
+    }
+    if (buffered() < *m_body_length) {
+        return std::optional<std::string_view> {};
+    }
+    std::string_view body { m_buffer.data() + m_start, *m_body_length };
+    m_scanned = m_start += *m_body_length;
+    m_body_length.reset();
+    return std::optional<std::string_view> { body };
+}
+
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <LibCore/JSON.h>
+
+namespace LSP {
+
+using namespace LibCore;
+
+// Splits the byte stream coming from the server into message bodies.
+// Incoming data is appended with feed(); next() returns complete bodies one
+// at a time, or an empty optional when the rest of a message hasn't arrived
+// yet. A header block is parsed once, and a partial body is not looked at
+// again until enough data is buffered to complete it.
+//
+// The views returned by next() are valid until the next call to feed().
+class MessageFramer {
+public:
+    static constexpr size_t MaxHeaderSize = 8 * 1024;
+
+    void                                               feed(std::string_view const &data);
+    Result<std::optional<std::string_view>, JSONError> next();
+    [[nodiscard]] size_t                               buffered() const { return m_buffer.length() - m_start; }
+    [[nodiscard]] bool                                 in_body() const { return m_body_length.has_value(); }
+
+private:
+    std::string           m_buffer {};
+    size_t                m_start { 0 };
+    size_t                m_scanned { 0 };
+    std::optional<size_t> m_body_length {};
+};
+
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <climits>
+#include <format>
+#include <print>
+#include <sys/fcntl.h>
+#include <sys/poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <vector>
+
+#include <LSP/MessageWriter.h>
+
+namespace LSP {
+
+MessageWriter::~MessageWriter()
+{
+    stop();
+}
+
+CError MessageWriter::start(int fd, Recorder *recorder)
+{
+    assert(m_fd < 0);
+    auto flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return LibCError();
+    }
+    m_fd = fd;
+    m_recorder = recorder;
+    m_thread = std::thread(&MessageWriter::run, this);
+    return {};
+}
+
+void MessageWriter::stop()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+CError MessageWriter::post(std::string body, Priority priority, std::optional<int> request_id)
+{
+    Message message {
+        std::format("Content-Length: {}\r\n\r\n", body.length()),
+        std::move(body),
+        request_id,
+    };
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_fd < 0 || m_stop || m_failed) {
+            return LibCError(EPIPE);
+        }
+        m_queued += message.size();
+        auto &queue = (priority == Priority::High) ? m_high : m_normal;
+        queue.push_back(std::move(message));
+    }
+    m_condition.notify_one();
+    return {};
+}
+
+bool MessageWriter::withdraw(int request_id)
+{
+    std::lock_guard lock(m_mutex);
+    auto            it = std::ranges::find(m_normal, std::optional { request_id }, &Message::request_id);
+    if (it == m_normal.end()) {
+        return false;
+    }
+    m_queued -= it->size();
+    m_normal.erase(it);
+    return true;
+}
+
+size_t MessageWriter::queued() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_queued;
+}
+
+void MessageWriter::run()
+{
+    std::deque<Message> batch;
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() {
+                return m_stop || !m_high.empty() || !m_normal.empty();
+            });
+            if (m_stop) {
+                return;
+            }
+            for (auto *queue : { &m_high, &m_normal }) {
+                while (!queue->empty() && batch.size() < MaxBatch) {
+                    batch.push_back(std::move(queue->front()));
+                    queue->pop_front();
+                }
+            }
+        }
+        auto   err = write_batch(batch);
+        size_t written = 0;
+        for (auto const &message : batch) {
+            written += message.size();
+            if (m_recorder != nullptr && !err.is_error()) {
+                m_recorder->record(Direction::ClientToServer, message.body);
+            }
+        }
+        batch.clear();
+        std::lock_guard lock(m_mutex);
+        m_queued -= written;
+        if (err.is_error()) {
+            std::println("ERROR Writing to LSP server: {}", err.error().description);
+            m_failed = true;
+            m_high.clear();
+            m_normal.clear();
+            m_queued = 0;
+            return;
+        }
+    }
+}
+
+// Writes the batch, resuming after partial writes. The descriptor is
+// non-blocking, so a server that doesn't read its input only stalls this
+// thread, which keeps checking whether it has been asked to stop.
+CError MessageWriter::write_batch(std::deque<Message> const &batch)
+{
+    std::vector<iovec> iov;
+    iov.reserve(batch.size() * 2);
+    for (auto const &message : batch) {
+        iov.push_back({ const_cast<char *>(message.header.data()), message.header.length() });
+        if (!message.body.empty()) {
+            iov.push_back({ const_cast<char *>(message.body.data()), message.body.length() });
+        }
+    }
+    size_t first = 0;
+    while (first < iov.size()) {
+        auto count = ::writev(m_fd, iov.data() + first, static_cast<int>(std::min<size_t>(iov.size() - first, IOV_MAX)));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                return LibCError();
+            }
+            pollfd poll_fd { m_fd, POLLOUT, 0 };
+            while (::poll(&poll_fd, 1, 100) == 0) {
+                std::lock_guard lock(m_mutex);
+                if (m_stop) {
+                    return {};
+                }
+            }
+            continue;
+        }
+        auto remaining = static_cast<size_t>(count);
+        while (first < iov.size() && remaining >= iov[first].iov_len) {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0) {
+            iov[first].iov_base = static_cast<char *>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+    return {};
+}
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <LibCore/Result.h>
+#include <LSP/Recorder.h>
+
+namespace LSP {
+
+using namespace LibCore;
+
+// Outgoing side of the connection to the server. post() frames a message
+// body and queues it without ever blocking on the server; a background
+// thread writes everything that has been queued with as few writev calls
+// as possible.
+//
+// High priority messages are written before anything in the normal queue.
+// A request that hasn't been written yet can be withdrawn, in which case
+// the server never sees it. Once more than HighWaterMark bytes are waiting
+// the writer reports itself congested, and callers are expected to hold
+// back messages that can be sent later.
+class MessageWriter {
+public:
+    enum class Priority {
+        Normal,
+        High,
+    };
+
+    static constexpr size_t HighWaterMark = 4 * 1024 * 1024;
+    static constexpr size_t MaxBatch = 64;
+
+    MessageWriter() = default;
+    MessageWriter(MessageWriter const &) = delete;
+    ~MessageWriter();
+
+    CError               start(int fd, Recorder *recorder = nullptr);
+    void                 stop();
+    CError               post(std::string body, Priority priority = Priority::Normal, std::optional<int> request_id = {});
+    bool                 withdraw(int request_id);
+    [[nodiscard]] size_t queued() const;
+    [[nodiscard]] bool   congested() const { return queued() >= HighWaterMark; }
+
+private:
+    struct Message {
+        std::string        header;
+        std::string        body;
+        std::optional<int> request_id;
+
+        [[nodiscard]] size_t size() const { return header.length() + body.length(); }
+    };
+
+    void   run();
+    CError write_batch(std::deque<Message> const &batch);
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Message>     m_high {};
+    std::deque<Message>     m_normal {};
+    size_t                  m_queued { 0 };
+    int                     m_fd { -1 };
+    Recorder               *m_recorder { nullptr };
+    bool                    m_stop { false };
+    bool                    m_failed { false };
+    std::thread             m_thread {};
+};
+
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <charconv>
+#include <format>
+#include <print>
+#include <sys/fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <LibCore/IO.h>
+#include <LSP/Recorder.h>
+
+namespace LSP {
+
+Recorder::~Recorder()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+CError Recorder::open(std::string_view const &file_name)
+{
+    assert(m_fd < 0);
+    auto fd = ::open(std::string { file_name }.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        return LibCError();
+    }
+    m_fd = fd;
+    m_start = std::chrono::steady_clock::now();
+    return {};
+}
+
+// Called from both the thread reading from and the thread writing to the
+// server. A failed write closes the recording rather than the connection.
+void Recorder::record(Direction direction, std::string_view const &body)
+{
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start);
+    auto header = std::format("{} {} {}\n", (direction == Direction::ClientToServer) ? '>' : '<', time.count(), body.length());
+    std::lock_guard lock(m_mutex);
+    if (m_fd < 0) {
+        return;
+    }
+    iovec iov[3] = {
+        { header.data(), header.length() },
+        { const_cast<char *>(body.data()), body.length() },
+        { const_cast<char *>("\n"), 1 },
+    };
+    auto total = header.length() + body.length() + 1;
+    if (::writev(m_fd, iov, 3) != static_cast<ssize_t>(total)) {
+        std::println("ERROR Writing LSP recording: {}", LibCError().description);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+Result<Recording, LibCError> read_recording(std::string_view const &file_name)
+{
+    auto      text = TRY_EVAL(read_file_by_name(file_name));
+    Recording ret;
+    size_t    pos = 0;
+    while (pos < text.length()) {
+        auto eol = text.find('\n', pos);
+        if (eol == std::string::npos || eol - pos < 5 || (text[pos] != '>' && text[pos] != '<') || text[pos + 1] != ' ') {
+            return LibCError("Malformed header at offset {} in recording '{}'", pos, file_name);
+        }
+        int64_t time;
+        size_t  length;
+        auto    header = std::string_view { text }.substr(pos + 2, eol - pos - 2);
+        auto    space = header.find(' ');
+        if (space == std::string_view::npos
+            || std::from_chars(header.data(), header.data() + space, time).ec != std::errc {}
+            || std::from_chars(header.data() + space + 1, header.data() + header.length(), length).ec != std::errc {}
+            || eol + 1 + length + 1 > text.length()) {
+            return LibCError("Malformed header at offset {} in recording '{}'", pos, file_name);
+        }
+        ret.push_back(RecordedMessage {
+            (text[pos] == '>') ? Direction::ClientToServer : Direction::ServerToClient,
+            std::chrono::microseconds { time },
+            text.substr(eol + 1, length),
+        });
+        pos = eol + 1 + length + 1;
+    }
+    return ret;
+}
+
+}
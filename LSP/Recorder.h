@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LibCore/Result.h>
+
+namespace LSP {
+
+using namespace LibCore;
+
+// A recording holds every message body exchanged with a server, each with
+// the time since recording started. A message is stored as a line with its
+// direction ('>' for client to server, '<' for server to client), the time
+// in microseconds and the length of the body, followed by the body and a
+// newline.
+enum class Direction {
+    ClientToServer,
+    ServerToClient,
+};
+
+struct RecordedMessage {
+    Direction                 direction;
+    std::chrono::microseconds time;
+    std::string               body;
+};
+
+using Recording = std::vector<RecordedMessage>;
+
+Result<Recording, LibCError> read_recording(std::string_view const &file_name);
+
+class Recorder {
+public:
+    Recorder() = default;
+    Recorder(Recorder const &) = delete;
+    ~Recorder();
+
+    CError             open(std::string_view const &file_name);
+    void               record(Direction direction, std::string_view const &body);
+    [[nodiscard]] bool is_open() const { return m_fd >= 0; }
+
+private:
+    std::mutex                            m_mutex;
+    std::atomic<int>                      m_fd { -1 };
+    std::chrono::steady_clock::time_point m_start {};
+};
+
+}
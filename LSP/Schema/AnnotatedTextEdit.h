@@ -24,9 +24,42 @@ struct AnnotatedTextEdit : public TextEdit {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, AnnotatedTextEdit &ret)
+    {
+        bool has_range { false };
+        bool has_newText { false };
+        bool has_annotationId { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            if (key == "newText") {
+                has_newText = true;
+                return read_json(reader, ret.newText);
+            }
+            if (key == "annotationId") {
+                has_annotationId = true;
+                return read_json(reader, ret.annotationId);
+            }
+            return reader.skip();
+        }));
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        if (!has_newText) {
+            return JSONError { JSONError::Code::MissingValue, "newText" };
+        }
+        if (!has_annotationId) {
+            return JSONError { JSONError::Code::MissingValue, "annotationId" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
+        ret.merge(TextEdit::encode());
         set(ret, "annotationId", annotationId);
         return ret;
     };
@@ -30,6 +30,28 @@ struct ChangeAnnotation {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, ChangeAnnotation &ret)
+    {
+        bool has_label { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "label") {
+                has_label = true;
+                return read_json(reader, ret.label);
+            }
+            if (key == "needsConfirmation") {
+                return read_json(reader, ret.needsConfirmation);
+            }
+            if (key == "description") {
+                return read_json(reader, ret.description);
+            }
+            return reader.skip();
+        }));
+        if (!has_label) {
+            return JSONError { JSONError::Code::MissingValue, "label" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -25,6 +25,17 @@ struct ClientCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, ClientCapabilities &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                return read_json(reader, ret.textDocument);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
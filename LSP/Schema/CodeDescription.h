@@ -23,6 +23,22 @@ struct CodeDescription {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, CodeDescription &ret)
+    {
+        bool has_href { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "href") {
+                has_href = true;
+                return read_json(reader, ret.href);
+            }
+            return reader.skip();
+        }));
+        if (!has_href) {
+            return JSONError { JSONError::Code::MissingValue, "href" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -27,6 +27,25 @@ struct CompletionContext {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, CompletionContext &ret)
+    {
+        bool has_triggerKind { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "triggerKind") {
+                has_triggerKind = true;
+                return read_json(reader, ret.triggerKind);
+            }
+            if (key == "triggerCharacter") {
+                return read_json(reader, ret.triggerCharacter);
+            }
+            return reader.skip();
+        }));
+        if (!has_triggerKind) {
+            return JSONError { JSONError::Code::MissingValue, "triggerKind" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -103,6 +103,76 @@ struct CompletionItem {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, CompletionItem &ret)
+    {
+        bool has_label { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "label") {
+                has_label = true;
+                return read_json(reader, ret.label);
+            }
+            if (key == "labelDetails") {
+                return read_json(reader, ret.labelDetails);
+            }
+            if (key == "kind") {
+                return read_json(reader, ret.kind);
+            }
+            if (key == "tags") {
+                return read_json(reader, ret.tags);
+            }
+            if (key == "detail") {
+                return read_json(reader, ret.detail);
+            }
+            if (key == "documentation") {
+                return read_json(reader, ret.documentation);
+            }
+            if (key == "deprecated") {
+                return read_json(reader, ret.deprecated);
+            }
+            if (key == "preselect") {
+                return read_json(reader, ret.preselect);
+            }
+            if (key == "sortText") {
+                return read_json(reader, ret.sortText);
+            }
+            if (key == "filterText") {
+                return read_json(reader, ret.filterText);
+            }
+            if (key == "insertText") {
+                return read_json(reader, ret.insertText);
+            }
+            if (key == "insertTextFormat") {
+                return read_json(reader, ret.insertTextFormat);
+            }
+            if (key == "insertTextMode") {
+                return read_json(reader, ret.insertTextMode);
+            }
+            if (key == "textEdit") {
+                return read_json(reader, ret.textEdit);
+            }
+            if (key == "textEditText") {
+                return read_json(reader, ret.textEditText);
+            }
+            if (key == "additionalTextEdits") {
+                return read_json(reader, ret.additionalTextEdits);
+            }
+            if (key == "commitCharacters") {
+                return read_json(reader, ret.commitCharacters);
+            }
+            if (key == "command") {
+                return read_json(reader, ret.command);
+            }
+            if (key == "data") {
+                return read_json(reader, ret.data);
+            }
+            return reader.skip();
+        }));
+        if (!has_label) {
+            return JSONError { JSONError::Code::MissingValue, "label" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
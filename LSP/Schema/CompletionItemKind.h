@@ -122,4 +122,18 @@ inline Decoded<CompletionItemKind> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, CompletionItemKind &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = CompletionItemKind_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'CompletionItemKind'",
+    };
+}
+
 } /* namespace LibCore */
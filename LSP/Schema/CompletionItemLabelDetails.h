@@ -28,6 +28,20 @@ struct CompletionItemLabelDetails {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, CompletionItemLabelDetails &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "detail") {
+                return read_json(reader, ret.detail);
+            }
+            if (key == "description") {
+                return read_json(reader, ret.description);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -50,4 +50,18 @@ inline Decoded<CompletionItemTag> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, CompletionItemTag &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = CompletionItemTag_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'CompletionItemTag'",
+    };
+}
+
 } /* namespace LibCore */
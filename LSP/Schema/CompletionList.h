@@ -32,6 +32,30 @@ struct CompletionList {
                 return std::move(ret);
             }
 
+            static EJSON read(JSONReader &reader, EditRange_1 &ret)
+            {
+                bool has_insert { false };
+                bool has_replace { false };
+                TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                    if (key == "insert") {
+                        has_insert = true;
+                        return read_json(reader, ret.insert);
+                    }
+                    if (key == "replace") {
+                        has_replace = true;
+                        return read_json(reader, ret.replace);
+                    }
+                    return reader.skip();
+                }));
+                if (!has_insert) {
+                    return JSONError { JSONError::Code::MissingValue, "insert" };
+                }
+                if (!has_replace) {
+                    return JSONError { JSONError::Code::MissingValue, "replace" };
+                }
+                return {};
+            }
+
             JSONValue encode() const
             {
                 JSONValue ret { JSONType::Object };
@@ -66,6 +90,29 @@ struct CompletionList {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, ItemDefaults &ret)
+        {
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                if (key == "commitCharacters") {
+                    return read_json(reader, ret.commitCharacters);
+                }
+                if (key == "editRange") {
+                    return read_json(reader, ret.editRange);
+                }
+                if (key == "insertTextFormat") {
+                    return read_json(reader, ret.insertTextFormat);
+                }
+                if (key == "insertTextMode") {
+                    return read_json(reader, ret.insertTextMode);
+                }
+                if (key == "data") {
+                    return read_json(reader, ret.data);
+                }
+                return reader.skip();
+            }));
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -91,6 +138,33 @@ struct CompletionList {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, CompletionList &ret)
+    {
+        bool has_isIncomplete { false };
+        bool has_items { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "isIncomplete") {
+                has_isIncomplete = true;
+                return read_json(reader, ret.isIncomplete);
+            }
+            if (key == "itemDefaults") {
+                return read_json(reader, ret.itemDefaults);
+            }
+            if (key == "items") {
+                has_items = true;
+                return read_json(reader, ret.items);
+            }
+            return reader.skip();
+        }));
+        if (!has_isIncomplete) {
+            return JSONError { JSONError::Code::MissingValue, "isIncomplete" };
+        }
+        if (!has_items) {
+            return JSONError { JSONError::Code::MissingValue, "items" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -28,9 +28,38 @@ struct CompletionParams : public TextDocumentPositionParams
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, CompletionParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_position { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "position") {
+                has_position = true;
+                return read_json(reader, ret.position);
+            }
+            if (key == "context") {
+                return read_json(reader, ret.context);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_position) {
+            return JSONError { JSONError::Code::MissingValue, "position" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
+        ret.merge(TextDocumentPositionParams::encode());
+        ret.merge(WorkDoneProgressParams::encode());
         set(ret, "context", context);
         return ret;
     };
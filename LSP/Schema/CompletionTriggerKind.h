@@ -56,4 +56,18 @@ inline Decoded<CompletionTriggerKind> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, CompletionTriggerKind &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = CompletionTriggerKind_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'CompletionTriggerKind'",
+    };
+}
+
 } /* namespace LibCore */
@@ -57,6 +57,51 @@ struct Diagnostic {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, Diagnostic &ret)
+    {
+        bool has_range { false };
+        bool has_message { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            if (key == "severity") {
+                return read_json(reader, ret.severity);
+            }
+            if (key == "code") {
+                return read_json(reader, ret.code);
+            }
+            if (key == "codeDescription") {
+                return read_json(reader, ret.codeDescription);
+            }
+            if (key == "source") {
+                return read_json(reader, ret.source);
+            }
+            if (key == "message") {
+                has_message = true;
+                return read_json(reader, ret.message);
+            }
+            if (key == "tags") {
+                return read_json(reader, ret.tags);
+            }
+            if (key == "relatedInformation") {
+                return read_json(reader, ret.relatedInformation);
+            }
+            if (key == "data") {
+                return read_json(reader, ret.data);
+            }
+            return reader.skip();
+        }));
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        if (!has_message) {
+            return JSONError { JSONError::Code::MissingValue, "message" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -25,6 +25,30 @@ struct DiagnosticRelatedInformation {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, DiagnosticRelatedInformation &ret)
+    {
+        bool has_location { false };
+        bool has_message { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "location") {
+                has_location = true;
+                return read_json(reader, ret.location);
+            }
+            if (key == "message") {
+                has_message = true;
+                return read_json(reader, ret.message);
+            }
+            return reader.skip();
+        }));
+        if (!has_location) {
+            return JSONError { JSONError::Code::MissingValue, "location" };
+        }
+        if (!has_message) {
+            return JSONError { JSONError::Code::MissingValue, "message" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -59,4 +59,18 @@ inline Decoded<DiagnosticSeverity> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, DiagnosticSeverity &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = DiagnosticSeverity_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'DiagnosticSeverity'",
+    };
+}
+
 } /* namespace LibCore */
@@ -53,4 +53,18 @@ inline Decoded<DiagnosticTag> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, DiagnosticTag &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = DiagnosticTag_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'DiagnosticTag'",
+    };
+}
+
 } /* namespace LibCore */
@@ -26,6 +26,30 @@ struct DidChangeTextDocumentParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, DidChangeTextDocumentParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_contentChanges { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "contentChanges") {
+                has_contentChanges = true;
+                return read_json(reader, ret.contentChanges);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_contentChanges) {
+            return JSONError { JSONError::Code::MissingValue, "contentChanges" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -23,6 +23,22 @@ struct DidOpenTextDocumentParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, DidOpenTextDocumentParams &ret)
+    {
+        bool has_textDocument { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -32,6 +32,23 @@ struct DocumentFilter {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, DocumentFilter &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "language") {
+                return read_json(reader, ret.language);
+            }
+            if (key == "scheme") {
+                return read_json(reader, ret.scheme);
+            }
+            if (key == "pattern") {
+                return read_json(reader, ret.pattern);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
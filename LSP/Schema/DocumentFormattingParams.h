@@ -27,9 +27,34 @@ struct DocumentFormattingParams : public WorkDoneProgressParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, DocumentFormattingParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_options { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "options") {
+                has_options = true;
+                return read_json(reader, ret.options);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_options) {
+            return JSONError { JSONError::Code::MissingValue, "options" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
+        ret.merge(WorkDoneProgressParams::encode());
         set(ret, "textDocument", textDocument);
         set(ret, "options", options);
         return ret;
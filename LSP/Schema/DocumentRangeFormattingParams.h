@@ -30,9 +30,42 @@ struct DocumentRangeFormattingParams : public WorkDoneProgressParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, DocumentRangeFormattingParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_range { false };
+        bool has_options { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            if (key == "options") {
+                has_options = true;
+                return read_json(reader, ret.options);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        if (!has_options) {
+            return JSONError { JSONError::Code::MissingValue, "options" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
+        ret.merge(WorkDoneProgressParams::encode());
         set(ret, "textDocument", textDocument);
         set(ret, "range", range);
         set(ret, "options", options);
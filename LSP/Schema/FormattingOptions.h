@@ -36,6 +36,39 @@ struct FormattingOptions {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, FormattingOptions &ret)
+    {
+        bool has_tabSize { false };
+        bool has_insertSpaces { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "tabSize") {
+                has_tabSize = true;
+                return read_json(reader, ret.tabSize);
+            }
+            if (key == "insertSpaces") {
+                has_insertSpaces = true;
+                return read_json(reader, ret.insertSpaces);
+            }
+            if (key == "trimTrailingWhitespace") {
+                return read_json(reader, ret.trimTrailingWhitespace);
+            }
+            if (key == "insertFinalNewline") {
+                return read_json(reader, ret.insertFinalNewline);
+            }
+            if (key == "trimFinalNewlines") {
+                return read_json(reader, ret.trimFinalNewlines);
+            }
+            return reader.skip();
+        }));
+        if (!has_tabSize) {
+            return JSONError { JSONError::Code::MissingValue, "tabSize" };
+        }
+        if (!has_insertSpaces) {
+            return JSONError { JSONError::Code::MissingValue, "insertSpaces" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
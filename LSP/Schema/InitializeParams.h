@@ -32,6 +32,25 @@ struct InitializeParams {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, ClientInfo &ret)
+        {
+            bool has_name { false };
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                if (key == "name") {
+                    has_name = true;
+                    return read_json(reader, ret.name);
+                }
+                if (key == "version") {
+                    return read_json(reader, ret.version);
+                }
+                return reader.skip();
+            }));
+            if (!has_name) {
+                return JSONError { JSONError::Code::MissingValue, "name" };
+            }
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -76,6 +95,56 @@ struct InitializeParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, InitializeParams &ret)
+    {
+        bool has_processId { false };
+        bool has_rootUri { false };
+        bool has_capabilities { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "processId") {
+                has_processId = true;
+                return read_json(reader, ret.processId);
+            }
+            if (key == "clientInfo") {
+                return read_json(reader, ret.clientInfo);
+            }
+            if (key == "locale") {
+                return read_json(reader, ret.locale);
+            }
+            if (key == "rootPath") {
+                return read_json(reader, ret.rootPath);
+            }
+            if (key == "rootUri") {
+                has_rootUri = true;
+                return read_json(reader, ret.rootUri);
+            }
+            if (key == "initializationOptions") {
+                return read_json(reader, ret.initializationOptions);
+            }
+            if (key == "capabilities") {
+                has_capabilities = true;
+                return read_json(reader, ret.capabilities);
+            }
+            if (key == "trace") {
+                return read_json(reader, ret.trace);
+            }
+            if (key == "workspaceFolders") {
+                return read_json(reader, ret.workspaceFolders);
+            }
+            return reader.skip();
+        }));
+        if (!has_processId) {
+            return JSONError { JSONError::Code::MissingValue, "processId" };
+        }
+        if (!has_rootUri) {
+            return JSONError { JSONError::Code::MissingValue, "rootUri" };
+        }
+        if (!has_capabilities) {
+            return JSONError { JSONError::Code::MissingValue, "capabilities" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
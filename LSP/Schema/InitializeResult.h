@@ -29,6 +29,25 @@ struct InitializeResult {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, ServerInfo &ret)
+        {
+            bool has_name { false };
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                if (key == "name") {
+                    has_name = true;
+                    return read_json(reader, ret.name);
+                }
+                if (key == "version") {
+                    return read_json(reader, ret.version);
+                }
+                return reader.skip();
+            }));
+            if (!has_name) {
+                return JSONError { JSONError::Code::MissingValue, "name" };
+            }
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -49,6 +68,25 @@ struct InitializeResult {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, InitializeResult &ret)
+    {
+        bool has_capabilities { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "capabilities") {
+                has_capabilities = true;
+                return read_json(reader, ret.capabilities);
+            }
+            if (key == "serverInfo") {
+                return read_json(reader, ret.serverInfo);
+            }
+            return reader.skip();
+        }));
+        if (!has_capabilities) {
+            return JSONError { JSONError::Code::MissingValue, "capabilities" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -27,6 +27,38 @@ struct InsertReplaceEdit {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, InsertReplaceEdit &ret)
+    {
+        bool has_newText { false };
+        bool has_insert { false };
+        bool has_replace { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "newText") {
+                has_newText = true;
+                return read_json(reader, ret.newText);
+            }
+            if (key == "insert") {
+                has_insert = true;
+                return read_json(reader, ret.insert);
+            }
+            if (key == "replace") {
+                has_replace = true;
+                return read_json(reader, ret.replace);
+            }
+            return reader.skip();
+        }));
+        if (!has_newText) {
+            return JSONError { JSONError::Code::MissingValue, "newText" };
+        }
+        if (!has_insert) {
+            return JSONError { JSONError::Code::MissingValue, "insert" };
+        }
+        if (!has_replace) {
+            return JSONError { JSONError::Code::MissingValue, "replace" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
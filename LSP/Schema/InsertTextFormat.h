@@ -53,4 +53,18 @@ inline Decoded<InsertTextFormat> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, InsertTextFormat &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = InsertTextFormat_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'InsertTextFormat'",
+    };
+}
+
 } /* namespace LibCore */
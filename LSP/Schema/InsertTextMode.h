@@ -53,4 +53,18 @@ inline Decoded<InsertTextMode> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, InsertTextMode &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = InsertTextMode_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'InsertTextMode'",
+    };
+}
+
 } /* namespace LibCore */
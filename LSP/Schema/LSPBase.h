@@ -7,6 +7,7 @@
 #pragma once
 
 #include <LibCore/JSON.h>
+#include <LibCore/JSONReader.h>
 
 namespace LSP {
 
@@ -28,6 +29,13 @@ struct Empty {
         }
         return Empty {};
     }
+
+    static EJSON read(JSONReader &reader, Empty &)
+    {
+        return reader.read_object([](std::string_view const &) -> EJSON {
+            return JSONError { JSONError::Code::TypeMismatch, "" };
+        });
+    }
 };
 
 struct Null {
@@ -43,6 +51,14 @@ struct Null {
         }
         return Null {};
     }
+
+    static EJSON read(JSONReader &reader, Null &)
+    {
+        if (!reader.accept_null()) {
+            return JSONError { JSONError::Code::TypeMismatch, "" };
+        }
+        return {};
+    }
 };
 
 struct Any {
@@ -57,6 +73,11 @@ struct Any {
     {
         return Any { json };
     }
+
+    static EJSON read(JSONReader &reader, Any &ret)
+    {
+        return read_json(reader, ret.value);
+    }
 };
 
 }
@@ -28,6 +28,33 @@ struct LSPCommand {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, LSPCommand &ret)
+    {
+        bool has_title { false };
+        bool has_command { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "title") {
+                has_title = true;
+                return read_json(reader, ret.title);
+            }
+            if (key == "command") {
+                has_command = true;
+                return read_json(reader, ret.command);
+            }
+            if (key == "arguments") {
+                return read_json(reader, ret.arguments);
+            }
+            return reader.skip();
+        }));
+        if (!has_title) {
+            return JSONError { JSONError::Code::MissingValue, "title" };
+        }
+        if (!has_command) {
+            return JSONError { JSONError::Code::MissingValue, "command" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
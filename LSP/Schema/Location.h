@@ -26,6 +26,30 @@ struct Location {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, Location &ret)
+    {
+        bool has_uri { false };
+        bool has_range { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "uri") {
+                has_uri = true;
+                return read_json(reader, ret.uri);
+            }
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            return reader.skip();
+        }));
+        if (!has_uri) {
+            return JSONError { JSONError::Code::MissingValue, "uri" };
+        }
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -32,6 +32,41 @@ struct LocationLink {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, LocationLink &ret)
+    {
+        bool has_targetUri { false };
+        bool has_targetRange { false };
+        bool has_targetSelectionRange { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "originSelectionRange") {
+                return read_json(reader, ret.originSelectionRange);
+            }
+            if (key == "targetUri") {
+                has_targetUri = true;
+                return read_json(reader, ret.targetUri);
+            }
+            if (key == "targetRange") {
+                has_targetRange = true;
+                return read_json(reader, ret.targetRange);
+            }
+            if (key == "targetSelectionRange") {
+                has_targetSelectionRange = true;
+                return read_json(reader, ret.targetSelectionRange);
+            }
+            return reader.skip();
+        }));
+        if (!has_targetUri) {
+            return JSONError { JSONError::Code::MissingValue, "targetUri" };
+        }
+        if (!has_targetRange) {
+            return JSONError { JSONError::Code::MissingValue, "targetRange" };
+        }
+        if (!has_targetSelectionRange) {
+            return JSONError { JSONError::Code::MissingValue, "targetSelectionRange" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
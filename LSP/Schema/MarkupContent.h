@@ -25,6 +25,30 @@ struct MarkupContent {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, MarkupContent &ret)
+    {
+        bool has_kind { false };
+        bool has_value { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "kind") {
+                has_kind = true;
+                return read_json(reader, ret.kind);
+            }
+            if (key == "value") {
+                has_value = true;
+                return read_json(reader, ret.value);
+            }
+            return reader.skip();
+        }));
+        if (!has_kind) {
+            return JSONError { JSONError::Code::MissingValue, "kind" };
+        }
+        if (!has_value) {
+            return JSONError { JSONError::Code::MissingValue, "value" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
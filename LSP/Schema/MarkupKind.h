@@ -56,4 +56,18 @@ inline Decoded<MarkupKind> decode(JSONValue const &json)
     return MarkupKind_from_string(json.to_string());
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, MarkupKind &obj)
+{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = MarkupKind_from_string(s); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'MarkupKind'",
+    };
+}
+
 } /* namespace LibCore */
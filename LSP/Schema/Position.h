@@ -24,6 +24,30 @@ struct Position {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, Position &ret)
+    {
+        bool has_line { false };
+        bool has_character { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "line") {
+                has_line = true;
+                return read_json(reader, ret.line);
+            }
+            if (key == "character") {
+                has_character = true;
+                return read_json(reader, ret.character);
+            }
+            return reader.skip();
+        }));
+        if (!has_line) {
+            return JSONError { JSONError::Code::MissingValue, "line" };
+        }
+        if (!has_character) {
+            return JSONError { JSONError::Code::MissingValue, "character" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -61,4 +61,18 @@ inline Decoded<PositionEncodingKind> decode(JSONValue const &json)
     return PositionEncodingKind_from_string(json.to_string());
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, PositionEncodingKind &obj)
+{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = PositionEncodingKind_from_string(s); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'PositionEncodingKind'",
+    };
+}
+
 } /* namespace LibCore */
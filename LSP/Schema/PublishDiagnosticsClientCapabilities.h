@@ -25,6 +25,22 @@ struct PublishDiagnosticsClientCapabilities {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, TagSupport &ret)
+        {
+            bool has_valueSet { false };
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                if (key == "valueSet") {
+                    has_valueSet = true;
+                    return read_json(reader, ret.valueSet);
+                }
+                return reader.skip();
+            }));
+            if (!has_valueSet) {
+                return JSONError { JSONError::Code::MissingValue, "valueSet" };
+            }
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -58,6 +74,29 @@ struct PublishDiagnosticsClientCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, PublishDiagnosticsClientCapabilities &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "relatedInformation") {
+                return read_json(reader, ret.relatedInformation);
+            }
+            if (key == "tagSupport") {
+                return read_json(reader, ret.tagSupport);
+            }
+            if (key == "versionSupport") {
+                return read_json(reader, ret.versionSupport);
+            }
+            if (key == "codeDescriptionSupport") {
+                return read_json(reader, ret.codeDescriptionSupport);
+            }
+            if (key == "dataSupport") {
+                return read_json(reader, ret.dataSupport);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
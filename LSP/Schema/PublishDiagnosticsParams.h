@@ -30,6 +30,33 @@ struct PublishDiagnosticsParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, PublishDiagnosticsParams &ret)
+    {
+        bool has_uri { false };
+        bool has_diagnostics { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "uri") {
+                has_uri = true;
+                return read_json(reader, ret.uri);
+            }
+            if (key == "version") {
+                return read_json(reader, ret.version);
+            }
+            if (key == "diagnostics") {
+                has_diagnostics = true;
+                return read_json(reader, ret.diagnostics);
+            }
+            return reader.skip();
+        }));
+        if (!has_uri) {
+            return JSONError { JSONError::Code::MissingValue, "uri" };
+        }
+        if (!has_diagnostics) {
+            return JSONError { JSONError::Code::MissingValue, "diagnostics" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -25,6 +25,30 @@ struct Range {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, Range &ret)
+    {
+        bool has_start { false };
+        bool has_end { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "start") {
+                has_start = true;
+                return read_json(reader, ret.start);
+            }
+            if (key == "end") {
+                has_end = true;
+                return read_json(reader, ret.end);
+            }
+            return reader.skip();
+        }));
+        if (!has_start) {
+            return JSONError { JSONError::Code::MissingValue, "start" };
+        }
+        if (!has_end) {
+            return JSONError { JSONError::Code::MissingValue, "end" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
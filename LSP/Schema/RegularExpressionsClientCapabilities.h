@@ -26,6 +26,25 @@ struct RegularExpressionsClientCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, RegularExpressionsClientCapabilities &ret)
+    {
+        bool has_engine { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "engine") {
+                has_engine = true;
+                return read_json(reader, ret.engine);
+            }
+            if (key == "version") {
+                return read_json(reader, ret.version);
+            }
+            return reader.skip();
+        }));
+        if (!has_engine) {
+            return JSONError { JSONError::Code::MissingValue, "engine" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
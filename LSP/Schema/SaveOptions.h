@@ -24,6 +24,17 @@ struct SaveOptions {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, SaveOptions &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "includeText") {
+                return read_json(reader, ret.includeText);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -96,4 +96,18 @@ inline Decoded<SemanticTokenModifiers> decode(JSONValue const &json)
     return SemanticTokenModifiers_from_string(json.to_string());
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, SemanticTokenModifiers &obj)
+{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = SemanticTokenModifiers_from_string(s); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'SemanticTokenModifiers'",
+    };
+}
+
 } /* namespace LibCore */
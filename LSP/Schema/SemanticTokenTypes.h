@@ -161,4 +161,18 @@ inline Decoded<SemanticTokenTypes> decode(JSONValue const &json)
     return SemanticTokenTypes_from_string(json.to_string());
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, SemanticTokenTypes &obj)
+{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = SemanticTokenTypes_from_string(s); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'SemanticTokenTypes'",
+    };
+}
+
 } /* namespace LibCore */
@@ -26,6 +26,25 @@ struct SemanticTokens {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, SemanticTokens &ret)
+    {
+        bool has_data { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "resultId") {
+                return read_json(reader, ret.resultId);
+            }
+            if (key == "data") {
+                has_data = true;
+                return read_json(reader, ret.data);
+            }
+            return reader.skip();
+        }));
+        if (!has_data) {
+            return JSONError { JSONError::Code::MissingValue, "data" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -24,6 +24,14 @@ struct SemanticTokensClientCapabilities {
                 return std::move(ret);
             }
 
+            static EJSON read(JSONReader &reader, Range_1 &ret)
+            {
+                TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                    return reader.skip();
+                }));
+                return {};
+            }
+
             JSONValue encode() const
             {
                 JSONValue ret { JSONType::Object };
@@ -43,6 +51,17 @@ struct SemanticTokensClientCapabilities {
                 return std::move(ret);
             }
 
+            static EJSON read(JSONReader &reader, Full_1 &ret)
+            {
+                TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                    if (key == "delta") {
+                        return read_json(reader, ret.delta);
+                    }
+                    return reader.skip();
+                }));
+                return {};
+            }
+
             JSONValue encode() const
             {
                 JSONValue ret { JSONType::Object };
@@ -64,6 +83,20 @@ struct SemanticTokensClientCapabilities {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, Requests &ret)
+        {
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                if (key == "range") {
+                    return read_json(reader, ret.range);
+                }
+                if (key == "full") {
+                    return read_json(reader, ret.full);
+                }
+                return reader.skip();
+            }));
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -106,6 +139,61 @@ struct SemanticTokensClientCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, SemanticTokensClientCapabilities &ret)
+    {
+        bool has_requests { false };
+        bool has_tokenTypes { false };
+        bool has_tokenModifiers { false };
+        bool has_formats { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "dynamicRegistration") {
+                return read_json(reader, ret.dynamicRegistration);
+            }
+            if (key == "requests") {
+                has_requests = true;
+                return read_json(reader, ret.requests);
+            }
+            if (key == "tokenTypes") {
+                has_tokenTypes = true;
+                return read_json(reader, ret.tokenTypes);
+            }
+            if (key == "tokenModifiers") {
+                has_tokenModifiers = true;
+                return read_json(reader, ret.tokenModifiers);
+            }
+            if (key == "formats") {
+                has_formats = true;
+                return read_json(reader, ret.formats);
+            }
+            if (key == "overlappingTokenSupport") {
+                return read_json(reader, ret.overlappingTokenSupport);
+            }
+            if (key == "multilineTokenSupport") {
+                return read_json(reader, ret.multilineTokenSupport);
+            }
+            if (key == "serverCancelSupport") {
+                return read_json(reader, ret.serverCancelSupport);
+            }
+            if (key == "augmentsSyntaxTokens") {
+                return read_json(reader, ret.augmentsSyntaxTokens);
+            }
+            return reader.skip();
+        }));
+        if (!has_requests) {
+            return JSONError { JSONError::Code::MissingValue, "requests" };
+        }
+        if (!has_tokenTypes) {
+            return JSONError { JSONError::Code::MissingValue, "tokenTypes" };
+        }
+        if (!has_tokenModifiers) {
+            return JSONError { JSONError::Code::MissingValue, "tokenModifiers" };
+        }
+        if (!has_formats) {
+            return JSONError { JSONError::Code::MissingValue, "formats" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
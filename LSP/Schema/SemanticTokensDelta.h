@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * THIS IS GENERATED CODE. DO NOT MODIFY.
+ */
+
+#pragma once
+
+#include <LSP/Schema/LSPBase.h>
+#include <LSP/Schema/SemanticTokensEdit.h>
+
+namespace LSP {
+
+struct SemanticTokensDelta {
+    std::optional<std::string>      resultId;
+    std::vector<SemanticTokensEdit> edits;
+
+    static Decoded<SemanticTokensDelta> decode(JSONValue const &json)
+    {
+        SemanticTokensDelta ret;
+        if (json.has("resultId")) {
+            ret.resultId = TRY_EVAL(json.try_get<std::string>("resultId"));
+        }
+        ret.edits = TRY_EVAL(json.try_get_array<SemanticTokensEdit>("edits"));
+        return std::move(ret);
+    }
+
+    static EJSON read(JSONReader &reader, SemanticTokensDelta &ret)
+    {
+        bool has_edits { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "resultId") {
+                return read_json(reader, ret.resultId);
+            }
+            if (key == "edits") {
+                has_edits = true;
+                return read_json(reader, ret.edits);
+            }
+            return reader.skip();
+        }));
+        if (!has_edits) {
+            return JSONError { JSONError::Code::MissingValue, "edits" };
+        }
+        return {};
+    }
+
+    JSONValue encode() const
+    {
+        JSONValue ret { JSONType::Object };
+        set(ret, "resultId", resultId);
+        set(ret, "edits", edits);
+        return ret;
+    };
+};
+
+} /* namespace LSP */
@@ -0,0 +1,61 @@
+/**
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * THIS IS GENERATED CODE. DO NOT MODIFY.
+ */
+
+#pragma once
+
+#include <LSP/Schema/LSPBase.h>
+#include <LSP/Schema/TextDocumentIdentifier.h>
+
+namespace LSP {
+
+struct SemanticTokensDeltaParams {
+    TextDocumentIdentifier textDocument;
+    std::string            previousResultId;
+
+    static Decoded<SemanticTokensDeltaParams> decode(JSONValue const &json)
+    {
+        SemanticTokensDeltaParams ret;
+        ret.textDocument = TRY_EVAL(json.try_get<TextDocumentIdentifier>("textDocument"));
+        ret.previousResultId = TRY_EVAL(json.try_get<std::string>("previousResultId"));
+        return std::move(ret);
+    }
+
+    static EJSON read(JSONReader &reader, SemanticTokensDeltaParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_previousResultId { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "previousResultId") {
+                has_previousResultId = true;
+                return read_json(reader, ret.previousResultId);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_previousResultId) {
+            return JSONError { JSONError::Code::MissingValue, "previousResultId" };
+        }
+        return {};
+    }
+
+    JSONValue encode() const
+    {
+        JSONValue ret { JSONType::Object };
+        set(ret, "textDocument", textDocument);
+        set(ret, "previousResultId", previousResultId);
+        return ret;
+    };
+};
+
+} /* namespace LSP */
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * THIS IS GENERATED CODE. DO NOT MODIFY.
+ */
+
+#pragma once
+
+#include <LSP/Schema/LSPBase.h>
+
+namespace LSP {
+
+struct SemanticTokensEdit {
+    uint32_t                             start;
+    uint32_t                             deleteCount;
+    std::optional<std::vector<uint32_t>> data;
+
+    static Decoded<SemanticTokensEdit> decode(JSONValue const &json)
+    {
+        SemanticTokensEdit ret;
+        ret.start = TRY_EVAL(json.try_get<uint32_t>("start"));
+        ret.deleteCount = TRY_EVAL(json.try_get<uint32_t>("deleteCount"));
+        if (json.has("data")) {
+            ret.data = TRY_EVAL(json.try_get_array<uint32_t>("data"));
+        }
+        return std::move(ret);
+    }
+
+    static EJSON read(JSONReader &reader, SemanticTokensEdit &ret)
+    {
+        bool has_start { false };
+        bool has_deleteCount { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "start") {
+                has_start = true;
+                return read_json(reader, ret.start);
+            }
+            if (key == "deleteCount") {
+                has_deleteCount = true;
+                return read_json(reader, ret.deleteCount);
+            }
+            if (key == "data") {
+                return read_json(reader, ret.data);
+            }
+            return reader.skip();
+        }));
+        if (!has_start) {
+            return JSONError { JSONError::Code::MissingValue, "start" };
+        }
+        if (!has_deleteCount) {
+            return JSONError { JSONError::Code::MissingValue, "deleteCount" };
+        }
+        return {};
+    }
+
+    JSONValue encode() const
+    {
+        JSONValue ret { JSONType::Object };
+        set(ret, "start", start);
+        set(ret, "deleteCount", deleteCount);
+        set(ret, "data", data);
+        return ret;
+    };
+};
+
+} /* namespace LSP */
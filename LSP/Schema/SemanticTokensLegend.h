@@ -24,6 +24,30 @@ struct SemanticTokensLegend {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, SemanticTokensLegend &ret)
+    {
+        bool has_tokenTypes { false };
+        bool has_tokenModifiers { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "tokenTypes") {
+                has_tokenTypes = true;
+                return read_json(reader, ret.tokenTypes);
+            }
+            if (key == "tokenModifiers") {
+                has_tokenModifiers = true;
+                return read_json(reader, ret.tokenModifiers);
+            }
+            return reader.skip();
+        }));
+        if (!has_tokenTypes) {
+            return JSONError { JSONError::Code::MissingValue, "tokenTypes" };
+        }
+        if (!has_tokenModifiers) {
+            return JSONError { JSONError::Code::MissingValue, "tokenModifiers" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
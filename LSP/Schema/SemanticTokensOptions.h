@@ -23,6 +23,14 @@ struct SemanticTokensOptions {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, Range_1 &ret)
+        {
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                return reader.skip();
+            }));
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -42,6 +50,17 @@ struct SemanticTokensOptions {
             return std::move(ret);
         }
 
+        static EJSON read(JSONReader &reader, Full_1 &ret)
+        {
+            TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+                if (key == "delta") {
+                    return read_json(reader, ret.delta);
+                }
+                return reader.skip();
+            }));
+            return {};
+        }
+
         JSONValue encode() const
         {
             JSONValue ret { JSONType::Object };
@@ -64,6 +83,28 @@ struct SemanticTokensOptions {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, SemanticTokensOptions &ret)
+    {
+        bool has_legend { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "legend") {
+                has_legend = true;
+                return read_json(reader, ret.legend);
+            }
+            if (key == "range") {
+                return read_json(reader, ret.range);
+            }
+            if (key == "full") {
+                return read_json(reader, ret.full);
+            }
+            return reader.skip();
+        }));
+        if (!has_legend) {
+            return JSONError { JSONError::Code::MissingValue, "legend" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * THIS IS GENERATED CODE. DO NOT MODIFY.
+ */
+
+#pragma once
+
+#include <LSP/Schema/LSPBase.h>
+#include <LSP/Schema/Range.h>
+#include <LSP/Schema/TextDocumentIdentifier.h>
+
+namespace LSP {
+
+struct SemanticTokensRangeParams {
+    TextDocumentIdentifier textDocument;
+    Range                  range;
+
+    static Decoded<SemanticTokensRangeParams> decode(JSONValue const &json)
+    {
+        SemanticTokensRangeParams ret;
+        ret.textDocument = TRY_EVAL(json.try_get<TextDocumentIdentifier>("textDocument"));
+        ret.range = TRY_EVAL(json.try_get<Range>("range"));
+        return std::move(ret);
+    }
+
+    static EJSON read(JSONReader &reader, SemanticTokensRangeParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_range { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        return {};
+    }
+
+    JSONValue encode() const
+    {
+        JSONValue ret { JSONType::Object };
+        set(ret, "textDocument", textDocument);
+        set(ret, "range", range);
+        return ret;
+    };
+};
+
+} /* namespace LSP */
@@ -36,6 +36,23 @@ struct ServerCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, ServerCapabilities &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "positionEncoding") {
+                return read_json(reader, ret.positionEncoding);
+            }
+            if (key == "textDocumentSync") {
+                return read_json(reader, ret.textDocumentSync);
+            }
+            if (key == "semanticTokensProvider") {
+                return read_json(reader, ret.semanticTokensProvider);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
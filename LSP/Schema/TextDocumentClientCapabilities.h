@@ -30,6 +30,20 @@ struct TextDocumentClientCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentClientCapabilities &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "synchronization") {
+                return read_json(reader, ret.synchronization);
+            }
+            if (key == "semanticTokens") {
+                return read_json(reader, ret.semanticTokens);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
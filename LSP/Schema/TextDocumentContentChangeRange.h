@@ -29,6 +29,33 @@ struct TextDocumentContentChangeRange {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentContentChangeRange &ret)
+    {
+        bool has_range { false };
+        bool has_text { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            if (key == "rangeLength") {
+                return read_json(reader, ret.rangeLength);
+            }
+            if (key == "text") {
+                has_text = true;
+                return read_json(reader, ret.text);
+            }
+            return reader.skip();
+        }));
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        if (!has_text) {
+            return JSONError { JSONError::Code::MissingValue, "text" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
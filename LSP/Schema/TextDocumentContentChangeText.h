@@ -22,6 +22,22 @@ struct TextDocumentContentChangeText {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentContentChangeText &ret)
+    {
+        bool has_text { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "text") {
+                has_text = true;
+                return read_json(reader, ret.text);
+            }
+            return reader.skip();
+        }));
+        if (!has_text) {
+            return JSONError { JSONError::Code::MissingValue, "text" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -23,6 +23,22 @@ struct TextDocumentIdentifier {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentIdentifier &ret)
+    {
+        bool has_uri { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "uri") {
+                has_uri = true;
+                return read_json(reader, ret.uri);
+            }
+            return reader.skip();
+        }));
+        if (!has_uri) {
+            return JSONError { JSONError::Code::MissingValue, "uri" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
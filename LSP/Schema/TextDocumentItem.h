@@ -29,6 +29,46 @@ struct TextDocumentItem {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentItem &ret)
+    {
+        bool has_uri { false };
+        bool has_languageId { false };
+        bool has_version { false };
+        bool has_text { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "uri") {
+                has_uri = true;
+                return read_json(reader, ret.uri);
+            }
+            if (key == "languageId") {
+                has_languageId = true;
+                return read_json(reader, ret.languageId);
+            }
+            if (key == "version") {
+                has_version = true;
+                return read_json(reader, ret.version);
+            }
+            if (key == "text") {
+                has_text = true;
+                return read_json(reader, ret.text);
+            }
+            return reader.skip();
+        }));
+        if (!has_uri) {
+            return JSONError { JSONError::Code::MissingValue, "uri" };
+        }
+        if (!has_languageId) {
+            return JSONError { JSONError::Code::MissingValue, "languageId" };
+        }
+        if (!has_version) {
+            return JSONError { JSONError::Code::MissingValue, "version" };
+        }
+        if (!has_text) {
+            return JSONError { JSONError::Code::MissingValue, "text" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
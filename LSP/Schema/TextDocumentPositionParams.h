@@ -26,6 +26,30 @@ struct TextDocumentPositionParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentPositionParams &ret)
+    {
+        bool has_textDocument { false };
+        bool has_position { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "textDocument") {
+                has_textDocument = true;
+                return read_json(reader, ret.textDocument);
+            }
+            if (key == "position") {
+                has_position = true;
+                return read_json(reader, ret.position);
+            }
+            return reader.skip();
+        }));
+        if (!has_textDocument) {
+            return JSONError { JSONError::Code::MissingValue, "textDocument" };
+        }
+        if (!has_position) {
+            return JSONError { JSONError::Code::MissingValue, "position" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
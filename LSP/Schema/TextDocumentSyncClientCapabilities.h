@@ -36,6 +36,26 @@ struct TextDocumentSyncClientCapabilities {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentSyncClientCapabilities &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "dynamicRegistration") {
+                return read_json(reader, ret.dynamicRegistration);
+            }
+            if (key == "willSave") {
+                return read_json(reader, ret.willSave);
+            }
+            if (key == "willSaveWaitUntil") {
+                return read_json(reader, ret.willSaveWaitUntil);
+            }
+            if (key == "didSave") {
+                return read_json(reader, ret.didSave);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
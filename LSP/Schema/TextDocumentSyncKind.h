@@ -56,4 +56,18 @@ inline Decoded<TextDocumentSyncKind> decode(JSONValue const &json)
     }
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, TextDocumentSyncKind &obj)
+{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = TextDocumentSyncKind_from_int(static_cast<int>(int_val)); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'TextDocumentSyncKind'",
+    };
+}
+
 } /* namespace LibCore */
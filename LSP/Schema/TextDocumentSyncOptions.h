@@ -42,6 +42,29 @@ struct TextDocumentSyncOptions {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextDocumentSyncOptions &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "openClose") {
+                return read_json(reader, ret.openClose);
+            }
+            if (key == "change") {
+                return read_json(reader, ret.change);
+            }
+            if (key == "willSave") {
+                return read_json(reader, ret.willSave);
+            }
+            if (key == "willSaveWaitUntil") {
+                return read_json(reader, ret.willSaveWaitUntil);
+            }
+            if (key == "save") {
+                return read_json(reader, ret.save);
+            }
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
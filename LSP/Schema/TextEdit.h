@@ -25,6 +25,30 @@ struct TextEdit {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, TextEdit &ret)
+    {
+        bool has_range { false };
+        bool has_newText { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "range") {
+                has_range = true;
+                return read_json(reader, ret.range);
+            }
+            if (key == "newText") {
+                has_newText = true;
+                return read_json(reader, ret.newText);
+            }
+            return reader.skip();
+        }));
+        if (!has_range) {
+            return JSONError { JSONError::Code::MissingValue, "range" };
+        }
+        if (!has_newText) {
+            return JSONError { JSONError::Code::MissingValue, "newText" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
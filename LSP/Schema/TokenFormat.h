@@ -51,4 +51,18 @@ inline Decoded<TokenFormat> decode(JSONValue const &json)
     return TokenFormat_from_string(json.to_string());
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, TokenFormat &obj)
+{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = TokenFormat_from_string(s); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'TokenFormat'",
+    };
+}
+
 } /* namespace LibCore */
@@ -61,4 +61,18 @@ inline Decoded<TraceValue> decode(JSONValue const &json)
     return TraceValue_from_string(json.to_string());
 }
 
+template<>
+inline EJSON read_json(JSONReader &reader, TraceValue &obj)
+{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = TraceValue_from_string(s); v) {
+        obj = *v;
+        return {};
+    }
+    return JSONError {
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to 'TraceValue'",
+    };
+}
+
 } /* namespace LibCore */
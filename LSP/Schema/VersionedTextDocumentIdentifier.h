@@ -23,9 +23,34 @@ struct VersionedTextDocumentIdentifier : public TextDocumentIdentifier {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, VersionedTextDocumentIdentifier &ret)
+    {
+        bool has_uri { false };
+        bool has_version { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "uri") {
+                has_uri = true;
+                return read_json(reader, ret.uri);
+            }
+            if (key == "version") {
+                has_version = true;
+                return read_json(reader, ret.version);
+            }
+            return reader.skip();
+        }));
+        if (!has_uri) {
+            return JSONError { JSONError::Code::MissingValue, "uri" };
+        }
+        if (!has_version) {
+            return JSONError { JSONError::Code::MissingValue, "version" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
+        ret.merge(TextDocumentIdentifier::encode());
         set(ret, "version", version);
         return ret;
     };
@@ -20,6 +20,14 @@ struct WorkDoneProgressParams {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, WorkDoneProgressParams &ret)
+    {
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            return reader.skip();
+        }));
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
@@ -25,6 +25,30 @@ struct WorkspaceFolder {
         return std::move(ret);
     }
 
+    static EJSON read(JSONReader &reader, WorkspaceFolder &ret)
+    {
+        bool has_uri { false };
+        bool has_name { false };
+        TRY(reader.read_object([&](std::string_view const &key) -> EJSON {
+            if (key == "uri") {
+                has_uri = true;
+                return read_json(reader, ret.uri);
+            }
+            if (key == "name") {
+                has_name = true;
+                return read_json(reader, ret.name);
+            }
+            return reader.skip();
+        }));
+        if (!has_uri) {
+            return JSONError { JSONError::Code::MissingValue, "uri" };
+        }
+        if (!has_name) {
+            return JSONError { JSONError::Code::MissingValue, "name" };
+        }
+        return {};
+    }
+
     JSONValue encode() const
     {
         JSONValue ret { JSONType::Object };
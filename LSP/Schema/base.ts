@@ -268,6 +268,27 @@ export interface SemanticTokens {
 	data: uinteger[];
 }
 
+export interface SemanticTokensDeltaParams {
+	textDocument: TextDocumentIdentifier;
+	previousResultId: string;
+}
+
+export interface SemanticTokensEdit {
+	start: uinteger;
+	deleteCount: uinteger;
+	data?: uinteger[];
+}
+
+export interface SemanticTokensDelta {
+	resultId?: string;
+	edits: SemanticTokensEdit[];
+}
+
+export interface SemanticTokensRangeParams {
+	textDocument: TextDocumentIdentifier;
+	range: Range;
+}
+
 interface DidOpenTextDocumentParams {
 	textDocument: TextDocumentItem;
 }
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+
+#include <LSP/ServerPool.h>
+
+namespace LSP {
+
+ServerPool &ServerPool::the()
+{
+    static ServerPool s_pool;
+    return s_pool;
+}
+
+EJSON ServerPool::configure(JSONValue const &settings)
+{
+    auto const &lsp_settings = settings.get("lsp").value_or(JSONValue(JSONType::Object));
+    int         timeout = DefaultIdleTimeout.count();
+    TRY(lsp_settings.get("idle_timeout").value_or(JSONValue { timeout }).convert<int>(timeout));
+    m_idle_timeout = std::chrono::seconds { std::max(timeout, 0) };
+    m_servers.clear();
+    for (auto const &server_settings : lsp_settings.get("servers").value_or(JSONValue(JSONType::Array))) {
+        m_servers.emplace_back(TRY_EVAL(ServerConfig::decode(server_settings)));
+    }
+    return {};
+}
+
+// Starts the servers marked prewarm. Their initialize handshake runs while
+// the rest of the editor starts up.
+void ServerPool::prewarm()
+{
+    for (auto &server : m_servers) {
+        if (server.config.prewarm && server.lsp == nullptr) {
+            start(server);
+        }
+    }
+}
+
+std::shared_ptr<LSP> ServerPool::server_for(std::string_view const &language)
+{
+    for (auto &server : m_servers) {
+        if (std::ranges::find(server.config.languages, language) == server.config.languages.end()) {
+            continue;
+        }
+        if (server.lsp == nullptr) {
+            start(server);
+            server.idle_since = Clock::now();
+        }
+        return server.lsp;
+    }
+    return nullptr;
+}
+
+void ServerPool::attach(std::shared_ptr<LSP> const &lsp)
+{
+    if (auto *server = find(lsp); server != nullptr) {
+        ++server->documents;
+        server->idle_since.reset();
+    }
+}
+
+void ServerPool::detach(std::shared_ptr<LSP> const &lsp)
+{
+    if (auto *server = find(lsp); server != nullptr && server->documents > 0) {
+        if (--server->documents == 0) {
+            server->idle_since = Clock::now();
+        }
+    }
+}
+
+// Runs once per frame. Shut down servers are kept around until the thread
+// reading their output is done with them, which is after the server has
+// seen the exit notification and has exited.
+void ServerPool::reap_idle()
+{
+    std::erase_if(m_retired, [](std::shared_ptr<LSP> const &lsp) {
+        if (!lsp->finished()) {
+            return false;
+        }
+        lsp->stop();
+        return true;
+    });
+    auto now = Clock::now();
+    for (auto &server : m_servers) {
+        if (server.lsp == nullptr || !server.idle_since || now - *server.idle_since < m_idle_timeout) {
+            continue;
+        }
+        server.lsp->shutdown().detach();
+        m_retired.push_back(std::move(server.lsp));
+        server.lsp = nullptr;
+        server.idle_since.reset();
+    }
+}
+
+void ServerPool::on_notification(std::string const &method, NotificationHandler handler)
+{
+    for (auto const &server : m_servers) {
+        if (server.lsp != nullptr) {
+            server.lsp->on_notification(method, handler);
+        }
+    }
+    m_notification_handlers[method] = std::move(handler);
+}
+
+ServerPool::Server *ServerPool::find(std::shared_ptr<LSP> const &lsp)
+{
+    if (lsp == nullptr) {
+        return nullptr;
+    }
+    auto it = std::ranges::find(m_servers, lsp, &Server::lsp);
+    return (it != m_servers.end()) ? &*it : nullptr;
+}
+
+void ServerPool::start(Server &server)
+{
+    server.lsp = Widget::make<LSP>(server.config);
+    for (auto const &[method, handler] : m_notification_handlers) {
+        server.lsp->on_notification(method, handler);
+    }
+    server.documents = 0;
+    server.idle_since.reset();
+}
+
+}
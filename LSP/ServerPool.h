@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LSP/LSP.h>
+
+namespace LSP {
+
+using namespace LibCore;
+
+constexpr auto DefaultIdleTimeout = std::chrono::seconds { 300 };
+
+// The language servers configured in settings.json. A server is started the
+// first time a buffer in one of its languages asks for it, or at startup if
+// it is marked prewarm. Starting a server doesn't wait for it: anything sent
+// before it has answered the initialize request is queued until it has.
+//
+// Buffers attach to the server while they are open. A server without any
+// attached buffers for idle_timeout seconds is shut down, and is started
+// again when it is needed. The idle clock of a prewarmed server doesn't run
+// until a buffer has attached to it and detached again.
+//
+// Notification handlers registered with the pool are installed on every
+// server it starts.
+class ServerPool {
+public:
+    static ServerPool &the();
+
+    EJSON                configure(JSONValue const &settings);
+    void                 prewarm();
+    std::shared_ptr<LSP> server_for(std::string_view const &language);
+    void                 attach(std::shared_ptr<LSP> const &lsp);
+    void                 detach(std::shared_ptr<LSP> const &lsp);
+    void                 reap_idle();
+    void                 on_notification(std::string const &method, NotificationHandler handler);
+
+private:
+    struct Server {
+        ServerConfig                     config;
+        std::shared_ptr<LSP>             lsp { nullptr };
+        size_t                           documents { 0 };
+        std::optional<Clock::time_point> idle_since {};
+    };
+
+    ServerPool() = default;
+    Server *find(std::shared_ptr<LSP> const &lsp);
+    void    start(Server &server);
+
+    std::vector<Server>               m_servers {};
+    std::vector<std::shared_ptr<LSP>> m_retired {};
+    std::chrono::seconds              m_idle_timeout { DefaultIdleTimeout };
+    NotificationHandlers              m_notification_handlers {};
+};
+
+}
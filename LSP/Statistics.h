@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LSP {
+
+// Round trip and decode times of the most recent MaxSamples requests. Samples
+// are added from the thread reading from the server.
+class RequestStatistics {
+public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    static constexpr size_t MaxSamples = 4096;
+
+    void add_latency(Duration latency)
+    {
+        std::lock_guard lock(m_mutex);
+        m_latencies.add(latency);
+    }
+
+    void add_decode_time(Duration decode_time)
+    {
+        std::lock_guard lock(m_mutex);
+        m_decode_times.add(decode_time);
+    }
+
+    void reset()
+    {
+        std::lock_guard lock(m_mutex);
+        m_latencies = {};
+        m_decode_times = {};
+    }
+
+    [[nodiscard]] std::string report() const
+    {
+        std::lock_guard lock(m_mutex);
+        auto            ms = [](Duration d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        return std::format("{} requests: latency p50 {:.2f} ms p99 {:.2f} ms, decode p50 {:.3f} ms p99 {:.3f} ms",
+            m_latencies.samples.size(),
+            ms(m_latencies.percentile(50)), ms(m_latencies.percentile(99)),
+            ms(m_decode_times.percentile(50)), ms(m_decode_times.percentile(99)));
+    }
+
+private:
+    struct Samples {
+        std::vector<Duration> samples {};
+        size_t                next { 0 };
+
+        void add(Duration sample)
+        {
+            if (samples.size() < MaxSamples) {
+                samples.push_back(sample);
+            } else {
+                samples[next] = sample;
+            }
+            next = (next + 1) % MaxSamples;
+        }
+
+        [[nodiscard]] Duration percentile(size_t p) const
+        {
+            if (samples.empty()) {
+                return Duration::zero();
+            }
+            auto sorted = samples;
+            auto nth = sorted.begin() + static_cast<std::ptrdiff_t>((sorted.size() - 1) * p / 100);
+            std::ranges::nth_element(sorted, nth);
+            return *nth;
+        }
+    };
+
+    mutable std::mutex m_mutex;
+    Samples            m_latencies {};
+    Samples            m_decode_times {};
+};
+
+}
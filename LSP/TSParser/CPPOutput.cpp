@@ -107,6 +107,20 @@ inline Decoded<{0}> decode(JSONValue const &json)
     return {0}_from_string(json.to_string());
 }}
 
+template<>
+inline EJSON read_json(JSONReader &reader, {0} &obj)
+{{
+    auto s = TRY_EVAL(reader.read_string());
+    if (auto v = {0}_from_string(s); v) {{
+        obj = *v;
+        return {{}};
+    }}
+    return JSONError {{
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to '{0}'",
+    }};
+}}
+
 }} /* namespace LibCore */
 )",
         type.name);
@@ -175,6 +189,20 @@ inline Decoded<{0}> decode(JSONValue const &json)
     }}
 }}
 
+template<>
+inline EJSON read_json(JSONReader &reader, {0} &obj)
+{{
+    auto int_val = TRY_EVAL(reader.read_integer());
+    if (auto v = {0}_from_int(static_cast<int>(int_val)); v) {{
+        obj = *v;
+        return {{}};
+    }}
+    return JSONError {{
+        JSONError::Code::UnexpectedValue,
+        "Cannot convert JSON value to '{0}'",
+    }};
+}}
+
 }} /* namespace LibCore */
 )",
         type.name);
@@ -220,6 +248,50 @@ void render_type(std::wostream &os, pType type, bool bare = false)
     }
 }
 
+void collect_properties(Interface const &iface, std::vector<Property const *> &props)
+{
+    for (auto const &ext : iface.extends) {
+        if (TypeDef::has(ext) && TypeDef::get(ext).kind == TypeDefKind::Interface) {
+            collect_properties(TypeDef::get(ext).interface(), props);
+        }
+    }
+    for (auto const &prop : iface.properties) {
+        props.push_back(&prop);
+    }
+}
+
+void emit_read(std::wostream &os, std::wstring_view const &name, Interface const &iface)
+{
+    std::vector<Property const *> props;
+    collect_properties(iface, props);
+    os << L"\nstatic EJSON read(JSONReader &reader, " << name << L" &ret) {\n";
+    for (auto const *prop : props) {
+        if (!prop->optional) {
+            os << L"bool has_" << prop->name << L" { false };\n";
+        }
+    }
+    os << L"TRY(reader.read_object([&](std::string_view const &key) -> EJSON {\n";
+    for (auto const *prop : props) {
+        os << L"if (key == \"" << prop->name << L"\") {\n";
+        if (!prop->optional) {
+            os << L"has_" << prop->name << L" = true;\n";
+        }
+        os << L"return read_json(reader, ret." << prop->name << L");\n";
+        os << L"}\n";
+    }
+    os << L"return reader.skip();\n";
+    os << L"}));\n";
+    for (auto const *prop : props) {
+        if (!prop->optional) {
+            os << L"if (!has_" << prop->name << L") {\n"
+               << L"return JSONError { JSONError::Code::MissingValue, \"" << prop->name << L"\" };\n"
+               << L"}\n";
+        }
+    }
+    os << L"return {};\n";
+    os << L"}\n";
+}
+
 void inline_struct(std::wostream &os, std::wstring_view const &name, Interface const &iface)
 {
     os << L"struct " << name << L" ";
@@ -254,10 +326,15 @@ void inline_struct(std::wostream &os, std::wstring_view const &name, Interface c
         }
     }
     os << L"         return std::move(ret);\n";
-    os << L"    }\n\n";
+    os << L"    }\n";
+    emit_read(os, name, iface);
+    os << L"\n";
 
     os << L"JSONValue encode() const {\n";
     os << L"JSONValue ret { JSONType::Object };\n";
+    for (auto const &ext : iface.extends) {
+        os << L"ret.merge(" << ext << L"::encode());\n";
+    }
     for (auto const &prop : iface.properties) {
         auto n = MUST_EVAL(to_utf8(prop.name));
         os << L"set(ret, \"" << prop.name << L"\", ";
@@ -127,7 +127,7 @@ pType Parser::parse_type()
 void Parser::parse_struct(Interface &interface)
 {
     if (m_lexer.accept(TokenKind::EndOfFile)) {
-        fatal("Expected field definition or '}'");
+        fatal("Expected field definition or '}}'");
     }
     if (m_lexer.accept_symbol('}')) {
         return;
@@ -337,8 +337,8 @@ void Parser::parse_enumeration()
         if (m_lexer.accept_symbol('}')) {
             break;
         }
-        if (!m_lexer.expect_symbol(',')) {
-            fatal("Expected ',' or '}'. Got '{}'", m_lexer.text_utf8(m_lexer.peek()));
+        if (m_lexer.expect_symbol(',').is_error()) {
+            fatal("Expected ',' or '}}'. Got '{}'", m_lexer.text_utf8(m_lexer.peek()));
         }
         if (m_lexer.accept_symbol('}')) {
             break;
@@ -6,7 +6,8 @@
 
 #include <LibCore/IO.h>
 #include <LibCore/JSON.h>
-#include <LibCore/Lexer.h>
+#include <LibCore/JSONReader.h>
+#include <LibCore/JSONWriter.h>
 
 namespace LibCore {
 
@@ -59,92 +60,12 @@ using namespace std::literals;
 
 [[nodiscard]] std::string JSONValue::serialize(bool pretty, int indent_width, int indent) const
 {
-    switch (type()) {
-    case JSONType::Null:
-    case JSONType::Integer:
-    case JSONType::Double:
-    case JSONType::Boolean:
-        return to_string();
-    case JSONType::String: {
-        auto s = to_string();
-        replace_all(s, "\r", R"(\r)");
-        replace_all(s, "\n", R"(\n)");
-        replace_all(s, "\t", R"(\t)");
-        replace_all(s, "\"", R"(\")");
-        return "\"" + s + "\"";
-    }
-    case JSONType::Array: {
-        auto const &array = std::get<Array>(m_value);
-        if (array.empty())
-            return "[]";
-        std::string ret = "[";
-        bool        first = true;
-        for (auto const &v : array) {
-            if (!first)
-                ret += ",";
-            if (pretty) {
-                ret += "\n";
-                for (auto i = 0u; i < indent + indent_width; ++i)
-                    ret += ' ';
-            } else {
-                ret += ' ';
-            }
-            first = false;
-            ret += v.serialize(pretty, indent_width, indent + indent_width);
-        }
-        if (pretty) {
-            ret += "\n";
-            for (auto i = 0u; i < indent; ++i)
-                ret += ' ';
-        } else {
-            ret += ' ';
-        }
-        return ret + "]";
-    }
-    case JSONType::Object: {
-        auto const &object = std::get<Object>(m_value);
-        if (object.empty())
-            return "{}";
-        std::string ret = "{";
-        bool        first = true;
-        for (auto const &v : object) {
-            if (!first)
-                ret += ",";
-            first = false;
-            if (pretty) {
-                ret += "\n";
-                for (auto i = 0u; i < indent + indent_width; ++i)
-                    ret += ' ';
-            } else {
-                ret += ' ';
-            }
-            ret += "\"" + v.first + "\": " + v.second.serialize();
-        }
-        if (pretty) {
-            ret += "\n";
-            for (auto i = 0u; i < indent; ++i)
-                ret += ' ';
-        } else {
-            ret += ' ';
-        }
-        return ret + "}";
-    }
-    }
-    UNREACHABLE();
+    std::string ret;
+    JSONWriter  writer { ret, pretty, indent_width, indent };
+    writer.write(*this);
+    return ret;
 }
 
-#define JSONKEYWORD(S) \
-    S(True, "true")    \
-    S(False, "false")  \
-    S(Null, "null")
-
-enum class JSONKeyword {
-#undef S
-#define S(kw, str) kw,
-    JSONKEYWORD(S)
-#undef S
-};
-
 Result<JSONValue, JSONValue::ReadError> JSONValue::read_file(std::string_view const &file_name)
 {
     trace(JSON, "Reading JSON file '{}'", file_name);
@@ -161,162 +82,12 @@ Result<JSONValue, JSONValue::ReadError> JSONValue::read_file(std::string_view co
     return json_maybe.value();
 }
 
-using JSONLexer = Lexer<std::string_view, EnumKeywords<std::string_view, SimpleKeywordCategory, JSONKeyword>, char>;
-using JSONToken = JSONLexer::Token;
-
-Result<JSONValue, JSONError> decode_value(JSONLexer &lexer, std::string_view const &str)
-{
-    auto decode_string = [str](JSONToken const &token) -> Result<std::string, JSONError> {
-        if (token != TokenKind::QuotedString) {
-            return JSONError {
-                JSONError::Code::SyntaxError,
-                "Expected quoted string",
-                static_cast<int>(token.location.line),
-                static_cast<int>(token.location.column),
-            };
-        }
-        if (!token.quoted_string().terminated) {
-            return JSONError {
-                JSONError::Code::SyntaxError,
-                "Unterminated string",
-                static_cast<int>(token.location.line),
-                static_cast<int>(token.location.column),
-            };
-        }
-        trace(JSON, "decode_string({})", token);
-        if (token.location.length > 2) {
-            std::string qstr { str.substr(token.location.index + 1, token.location.length - 2) };
-            replace_all(qstr, R"(\r)", "\r"sv);
-            replace_all(qstr, R"(\n)", "\n"sv);
-            replace_all(qstr, R"(\t)", "\t"sv);
-            replace_all(qstr, R"(\")", R"(")");
-            replace_all(qstr, R"(\')", "'"sv);
-            return { qstr };
-        }
-        return std::string {};
-    };
-
-    auto expect_symbol = [&lexer](int sym) -> Error<JSONError> {
-        auto err = lexer.expect_symbol(sym);
-        if (err.is_error()) {
-            auto const &error_token = lexer.peek();
-            return JSONError {
-                JSONError::Code::SyntaxError,
-                std::format("Expected '{:c}'", sym),
-                static_cast<int>(error_token.location.line),
-                static_cast<int>(error_token.location.column),
-            };
-        }
-        return {};
-    };
-
-    auto const &token = lexer.lex();
-    trace(JSON, "decode_value token: {}", token);
-    switch (token.kind) {
-    case TokenKind::Symbol: {
-        switch (token.symbol_code()) {
-        case '{': {
-            auto result = JSONValue::object();
-            while (!lexer.accept_symbol('}')) {
-                auto const name_token = lexer.lex();
-                trace(JSON, "name_token: {}", name_token);
-                auto name = TRY_EVAL(decode_string(name_token));
-                trace(JSON, "Name: {}", name);
-                TRY(expect_symbol(':'));
-                auto value = TRY_EVAL(decode_value(lexer, str));
-                trace(JSON, "NVP: {}: {}", name, value.to_string());
-                result.set(name, value);
-                if (!lexer.accept_symbol(',')) {
-                    TRY(expect_symbol('}'));
-                    break;
-                }
-            }
-            return result;
-        }
-        case '[': {
-            auto result = JSONValue::array();
-            while (!lexer.accept_symbol(']')) {
-                auto value = TRY_EVAL(decode_value(lexer, str));
-                trace(JSON, "Array elem: {}", value.to_string());
-                result.append(value);
-                if (!lexer.accept_symbol(',')) {
-                    TRY(expect_symbol(']'));
-                    break;
-                }
-            }
-            return result;
-        }
-        default:
-            return JSONError {
-                JSONError::Code::SyntaxError,
-                std::format("Unexpected symbol '{:c}'", token.symbol_code()),
-                static_cast<int>(token.location.line),
-                static_cast<int>(token.location.column),
-            };
-        }
-    }
-    case TokenKind::QuotedString: {
-        trace(JSON, "QuotedString: {}", token);
-        return JSONValue { TRY_EVAL(decode_string(token)) };
-    }
-    case TokenKind::Number: {
-        switch (token.number_type()) {
-        case NumberType::Decimal: {
-            auto dbl_maybe = string_to_double(std::string(str.substr(token.location.index, token.location.length)));
-            assert(dbl_maybe.has_value());
-            return JSONValue(dbl_maybe.value());
-        }
-        default: {
-            auto int_maybe = string_to_integer<long>(str.substr(token.location.index, token.location.length));
-            assert(int_maybe.has_value());
-            return JSONValue(int_maybe.value());
-        }
-        }
-    }
-    case TokenKind::Keyword: {
-        switch (token.keyword().code) {
-        case JSONKeyword::False:
-            return JSONValue(false);
-        case JSONKeyword::True:
-            return JSONValue(true);
-        case JSONKeyword::Null:
-            return JSONValue();
-        default:
-            UNREACHABLE();
-        }
-    }
-    default:
-        return JSONError {
-            JSONError::Code::SyntaxError,
-            std::format("Invalid token '{:}' ({:})", str.substr(token.location.index, token.location.length), TokenKind_name(token.kind)),
-            static_cast<int>(token.location.line),
-            static_cast<int>(token.location.column),
-        };
-    }
-}
-
-template<>
-[[nodiscard]] std::optional<std::tuple<SimpleKeywordCategory, JSONKeyword, MatchType>> match_keyword(std::string const &str)
-{
-#undef S
-#define S(KW, STR)                                                       \
-    if (std::string_view(STR).starts_with(str)) {                        \
-        return std::tuple {                                              \
-            SimpleKeywordCategory::Keyword,                              \
-            JSONKeyword::KW,                                             \
-            (str == STR) ? MatchType::FullMatch : MatchType::PrefixMatch \
-        };                                                               \
-    }
-    JSONKEYWORD(S)
-#undef S
-    return {};
-}
-
 Result<JSONValue, JSONError> JSONValue::deserialize(std::string_view const &str)
 {
-    JSONLexer lexer;
-    lexer.push_source(str);
-    return decode_value(lexer, str);
+    JSONReader  reader { str };
+    JSONBuilder builder;
+    TRY(reader.read(builder));
+    return std::move(builder.result());
 }
 
 }
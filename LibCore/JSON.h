@@ -249,6 +249,9 @@ public:
 
     JSONValue() = default;
     JSONValue(JSONValue const &) = default;
+    JSONValue(JSONValue &&) noexcept = default;
+    JSONValue &operator=(JSONValue const &) = default;
+    JSONValue &operator=(JSONValue &&) noexcept = default;
 
     JSONValue(JSONType type)
         : m_type(type)
@@ -549,6 +552,14 @@ public:
         array.push_back(value);
     }
 
+    void append(JSONValue &&value)
+    {
+        if (m_type != JSONType::Array)
+            return;
+        auto &array = std::get<Array>(m_value);
+        array.push_back(std::move(value));
+    }
+
     JSONValue &operator+=(JSONValue const &value)
     {
         append(value);
@@ -563,6 +574,14 @@ public:
         object[std::string(key)] = value;
     }
 
+    void set(std::string_view const &key, JSONValue &&value)
+    {
+        if (m_type != JSONType::Object)
+            return;
+        auto &object = std::get<Object>(m_value);
+        object.insert_or_assign(std::string(key), std::move(value));
+    }
+
     [[nodiscard]] size_t size() const
     {
         switch (m_type) {
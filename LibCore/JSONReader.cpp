@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <charconv>
+#include <cmath>
+
+#include <LibCore/JSONReader.h>
+
+namespace LibCore {
+
+using namespace std::literals;
+
+/*
+ * ---------------------------------------------------------------------------
+ * -- JSONReader
+ * ---------------------------------------------------------------------------
+ */
+
+EJSON JSONReader::read(JSONHandler &handler)
+{
+    m_index = 0;
+    TRY(read_next(handler));
+    return expect_end();
+}
+
+EJSON JSONReader::read_next(JSONHandler &handler)
+{
+    skip_whitespace();
+    return parse_value(handler, 0);
+}
+
+EJSON JSONReader::skip()
+{
+    skip_whitespace();
+    return skip_value(0);
+}
+
+EJSON JSONReader::expect_end()
+{
+    skip_whitespace();
+    if (m_index < m_text.length()) {
+        return error("Unexpected characters after JSON value");
+    }
+    return {};
+}
+
+bool JSONReader::accept_null()
+{
+    skip_whitespace();
+    if (m_text.substr(m_index).starts_with("null"sv)) {
+        m_index += 4;
+        return true;
+    }
+    return false;
+}
+
+Result<std::string_view, JSONError> JSONReader::read_string()
+{
+    skip_whitespace();
+    if (m_index >= m_text.length() || m_text[m_index] != '"') {
+        return error("Expected quoted string");
+    }
+    return scan_string();
+}
+
+Result<int64_t, JSONError> JSONReader::read_integer()
+{
+    skip_whitespace();
+    if (m_index >= m_text.length() || (m_text[m_index] != '-' && !is_digit())) {
+        return error("Expected integer");
+    }
+    auto start = m_index;
+    auto number = TRY_EVAL(scan_number());
+    if (number.is_double) {
+        // Only a whole number within the range of int64_t converts exactly.
+        if (!(number.dbl >= -0x1p63 && number.dbl < 0x1p63) || std::trunc(number.dbl) != number.dbl) {
+            return error(JSONError::Code::TypeMismatch, "Number is not an integer", start);
+        }
+        return static_cast<int64_t>(number.dbl);
+    }
+    return number.integer;
+}
+
+Result<double, JSONError> JSONReader::read_double()
+{
+    skip_whitespace();
+    if (m_index >= m_text.length() || (m_text[m_index] != '-' && !is_digit())) {
+        return error("Expected number");
+    }
+    auto number = TRY_EVAL(scan_number());
+    if (number.is_double) {
+        return number.dbl;
+    }
+    return static_cast<double>(number.integer);
+}
+
+Result<bool, JSONError> JSONReader::read_boolean()
+{
+    skip_whitespace();
+    if (m_index < m_text.length()) {
+        switch (m_text[m_index]) {
+        case 't':
+            TRY(read_literal("true"sv));
+            return true;
+        case 'f':
+            TRY(read_literal("false"sv));
+            return false;
+        default:
+            break;
+        }
+    }
+    return error("Expected boolean");
+}
+
+JSONError JSONReader::error(JSONError::Code code, std::string_view const &msg, size_t at) const
+{
+    int line = 0;
+    int column = 0;
+    for (auto ix = 0u; ix < at && ix < m_text.length(); ++ix) {
+        if (m_text[ix] == '\n') {
+            ++line;
+            column = 0;
+        } else {
+            ++column;
+        }
+    }
+    return JSONError { code, msg, line, column };
+}
+
+void JSONReader::skip_whitespace()
+{
+    while (m_index < m_text.length()) {
+        switch (m_text[m_index]) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+            ++m_index;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+bool JSONReader::accept(char ch)
+{
+    if (m_index < m_text.length() && m_text[m_index] == ch) {
+        ++m_index;
+        return true;
+    }
+    return false;
+}
+
+EJSON JSONReader::parse_value(JSONHandler &handler, int depth)
+{
+    if (depth > MaxDepth) {
+        return error("Maximum nesting depth exceeded");
+    }
+    if (m_index >= m_text.length()) {
+        return error("Unexpected end of input");
+    }
+    switch (m_text[m_index]) {
+    case '{':
+        return parse_object(handler, depth);
+    case '[':
+        return parse_array(handler, depth);
+    case '"':
+        return handler.on_string(TRY_EVAL(scan_string()));
+    case 't':
+        TRY(read_literal("true"sv));
+        return handler.on_boolean(true);
+    case 'f':
+        TRY(read_literal("false"sv));
+        return handler.on_boolean(false);
+    case 'n':
+        TRY(read_literal("null"sv));
+        return handler.on_null();
+    case '-':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9': {
+        auto number = TRY_EVAL(scan_number());
+        if (number.is_double) {
+            return handler.on_double(number.dbl);
+        }
+        return handler.on_integer(number.integer);
+    }
+    default:
+        return error(std::format("Unexpected character '{:c}'", m_text[m_index]));
+    }
+}
+
+EJSON JSONReader::parse_object(JSONHandler &handler, int depth)
+{
+    ++m_index;
+    TRY(handler.on_begin_object());
+    skip_whitespace();
+    if (accept('}')) {
+        return handler.on_end_object();
+    }
+    while (true) {
+        skip_whitespace();
+        if (m_index >= m_text.length() || m_text[m_index] != '"') {
+            return error("Expected quoted string");
+        }
+        TRY(handler.on_key(TRY_EVAL(scan_string())));
+        skip_whitespace();
+        if (!accept(':')) {
+            return error("Expected ':'");
+        }
+        skip_whitespace();
+        TRY(parse_value(handler, depth + 1));
+        skip_whitespace();
+        if (accept(',')) {
+            continue;
+        }
+        if (accept('}')) {
+            return handler.on_end_object();
+        }
+        return error("Expected ',' or '}'");
+    }
+}
+
+EJSON JSONReader::parse_array(JSONHandler &handler, int depth)
+{
+    ++m_index;
+    TRY(handler.on_begin_array());
+    skip_whitespace();
+    if (accept(']')) {
+        return handler.on_end_array();
+    }
+    while (true) {
+        skip_whitespace();
+        TRY(parse_value(handler, depth + 1));
+        skip_whitespace();
+        if (accept(',')) {
+            continue;
+        }
+        if (accept(']')) {
+            return handler.on_end_array();
+        }
+        return error("Expected ',' or ']'");
+    }
+}
+
+EJSON JSONReader::skip_value(int depth)
+{
+    if (depth > MaxDepth) {
+        return error("Maximum nesting depth exceeded");
+    }
+    if (m_index >= m_text.length()) {
+        return error("Unexpected end of input");
+    }
+    switch (m_text[m_index]) {
+    case '{':
+        ++m_index;
+        skip_whitespace();
+        if (accept('}')) {
+            return {};
+        }
+        while (true) {
+            skip_whitespace();
+            if (m_index >= m_text.length() || m_text[m_index] != '"') {
+                return error("Expected quoted string");
+            }
+            TRY(skip_string());
+            skip_whitespace();
+            if (!accept(':')) {
+                return error("Expected ':'");
+            }
+            skip_whitespace();
+            TRY(skip_value(depth + 1));
+            skip_whitespace();
+            if (accept(',')) {
+                continue;
+            }
+            if (accept('}')) {
+                return {};
+            }
+            return error("Expected ',' or '}'");
+        }
+    case '[':
+        ++m_index;
+        skip_whitespace();
+        if (accept(']')) {
+            return {};
+        }
+        while (true) {
+            skip_whitespace();
+            TRY(skip_value(depth + 1));
+            skip_whitespace();
+            if (accept(',')) {
+                continue;
+            }
+            if (accept(']')) {
+                return {};
+            }
+            return error("Expected ',' or ']'");
+        }
+    case '"':
+        return skip_string();
+    case 't':
+        return read_literal("true"sv);
+    case 'f':
+        return read_literal("false"sv);
+    case 'n':
+        return read_literal("null"sv);
+    default:
+        TRY(scan_number());
+        return {};
+    }
+}
+
+// Like scan_string(), but only validates escapes instead of decoding them.
+EJSON JSONReader::skip_string()
+{
+    auto start = m_index++;
+    while (m_index < m_text.length()) {
+        switch (m_text[m_index++]) {
+        case '"':
+            return {};
+        case '\\':
+            if (m_index >= m_text.length()) {
+                return error("Unterminated string", start);
+            }
+            if (m_text[m_index++] == 'u') {
+                TRY(read_hex4());
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return error("Unterminated string", start);
+}
+
+EJSON JSONReader::read_literal(std::string_view const &literal)
+{
+    if (!m_text.substr(m_index).starts_with(literal)) {
+        return error("Invalid literal");
+    }
+    m_index += literal.length();
+    return {};
+}
+
+Result<JSONReader::Number, JSONError> JSONReader::scan_number()
+{
+    auto skip_digits = [this]() {
+        while (is_digit()) {
+            ++m_index;
+        }
+    };
+
+    auto start = m_index;
+    bool is_double = false;
+    accept('-');
+    if (accept('0')) {
+        // No leading zeroes
+    } else if (is_digit()) {
+        skip_digits();
+    } else {
+        return error("Invalid number", start);
+    }
+    if (accept('.')) {
+        if (!is_digit()) {
+            return error("Expected digit after decimal point");
+        }
+        skip_digits();
+        is_double = true;
+    }
+    if (accept('e') || accept('E')) {
+        if (!accept('+')) {
+            accept('-');
+        }
+        if (!is_digit()) {
+            return error("Expected digit in exponent");
+        }
+        skip_digits();
+        is_double = true;
+    }
+
+    auto const *first = m_text.data() + start;
+    auto const *last = m_text.data() + m_index;
+    if (!is_double) {
+        int64_t int_value;
+        auto [ptr, ec] = std::from_chars(first, last, int_value);
+        if (ec == std::errc {}) {
+            return Number { .integer = int_value };
+        }
+        // Out of range for int64_t: fall back to a double.
+    }
+    double dbl_value;
+    auto [ptr, ec] = std::from_chars(first, last, dbl_value);
+    if (ec != std::errc {}) {
+        return error("Invalid number", start);
+    }
+    return Number { .is_double = true, .dbl = dbl_value };
+}
+
+Result<std::string_view, JSONError> JSONReader::scan_string()
+{
+    auto start = ++m_index;
+    while (m_index < m_text.length() && m_text[m_index] != '"' && m_text[m_index] != '\\') {
+        ++m_index;
+    }
+    if (m_index >= m_text.length()) {
+        return error("Unterminated string", start - 1);
+    }
+    if (m_text[m_index] == '"') {
+        return m_text.substr(start, m_index++ - start);
+    }
+
+    m_scratch.assign(m_text.substr(start, m_index - start));
+    while (m_index < m_text.length()) {
+        switch (m_text[m_index]) {
+        case '"':
+            ++m_index;
+            return std::string_view { m_scratch };
+        case '\\':
+            TRY(read_escape());
+            break;
+        default: {
+            auto run = m_index;
+            while (m_index < m_text.length() && m_text[m_index] != '"' && m_text[m_index] != '\\') {
+                ++m_index;
+            }
+            m_scratch.append(m_text.substr(run, m_index - run));
+        } break;
+        }
+    }
+    return error("Unterminated string", start - 1);
+}
+
+Result<uint32_t, JSONError> JSONReader::read_hex4()
+{
+    if (m_index + 4 > m_text.length()) {
+        return error("Truncated unicode escape");
+    }
+    uint32_t ret = 0;
+    auto [ptr, ec] = std::from_chars(m_text.data() + m_index, m_text.data() + m_index + 4, ret, 16);
+    if (ec != std::errc {} || ptr != m_text.data() + m_index + 4) {
+        return error("Invalid unicode escape");
+    }
+    m_index += 4;
+    return ret;
+}
+
+EJSON JSONReader::read_escape()
+{
+    auto escape_start = m_index++;
+    if (m_index >= m_text.length()) {
+        return error("Unterminated string");
+    }
+    switch (m_text[m_index++]) {
+    case '"':
+        m_scratch += '"';
+        return {};
+    case '\\':
+        m_scratch += '\\';
+        return {};
+    case '/':
+        m_scratch += '/';
+        return {};
+    case '\'':
+        m_scratch += '\'';
+        return {};
+    case 'b':
+        m_scratch += '\b';
+        return {};
+    case 'f':
+        m_scratch += '\f';
+        return {};
+    case 'n':
+        m_scratch += '\n';
+        return {};
+    case 'r':
+        m_scratch += '\r';
+        return {};
+    case 't':
+        m_scratch += '\t';
+        return {};
+    case 'u':
+        break;
+    default:
+        return error("Invalid escape sequence", escape_start);
+    }
+
+    uint32_t code_point = TRY_EVAL(read_hex4());
+    if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+        return error("Unpaired low surrogate in unicode escape", escape_start);
+    }
+    if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+        if (!m_text.substr(m_index).starts_with("\\u"sv)) {
+            return error("Unpaired high surrogate in unicode escape", escape_start);
+        }
+        m_index += 2;
+        uint32_t low = TRY_EVAL(read_hex4());
+        if (low < 0xDC00 || low > 0xDFFF) {
+            return error("Invalid low surrogate in unicode escape", escape_start);
+        }
+        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    if (code_point < 0x80) {
+        m_scratch += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        m_scratch += static_cast<char>(0xC0 | (code_point >> 6));
+        m_scratch += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        m_scratch += static_cast<char>(0xE0 | (code_point >> 12));
+        m_scratch += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        m_scratch += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        m_scratch += static_cast<char>(0xF0 | (code_point >> 18));
+        m_scratch += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        m_scratch += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        m_scratch += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+    return {};
+}
+
+/*
+ * ---------------------------------------------------------------------------
+ * -- JSONBuilder
+ * ---------------------------------------------------------------------------
+ */
+
+EJSON JSONBuilder::add(JSONValue value)
+{
+    if (m_stack.empty()) {
+        m_result = std::move(value);
+        return {};
+    }
+    auto &top = m_stack.back();
+    if (top.is_array()) {
+        top.append(std::move(value));
+        return {};
+    }
+    assert(!m_keys.empty());
+    top.set(m_keys.back(), std::move(value));
+    m_keys.pop_back();
+    return {};
+}
+
+EJSON JSONBuilder::on_key(std::string_view const &key)
+{
+    m_keys.emplace_back(key);
+    return {};
+}
+
+EJSON JSONBuilder::on_begin_object()
+{
+    m_stack.push_back(JSONValue::object());
+    return {};
+}
+
+EJSON JSONBuilder::on_end_object()
+{
+    auto value = std::move(m_stack.back());
+    m_stack.pop_back();
+    return add(std::move(value));
+}
+
+EJSON JSONBuilder::on_begin_array()
+{
+    m_stack.push_back(JSONValue::array());
+    return {};
+}
+
+EJSON JSONBuilder::on_end_array()
+{
+    auto value = std::move(m_stack.back());
+    m_stack.pop_back();
+    return add(std::move(value));
+}
+
+}
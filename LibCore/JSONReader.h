@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LibCore/JSON.h>
+
+namespace LibCore {
+
+using EJSON = Error<JSONError>;
+
+// String and key views handed to a handler point either into the input text
+// or into the reader's scratch buffer. They are only valid for the duration
+// of the callback.
+class JSONHandler {
+public:
+    virtual ~JSONHandler() = default;
+
+    virtual EJSON on_null() { return {}; }
+    virtual EJSON on_boolean(bool) { return {}; }
+    virtual EJSON on_integer(int64_t) { return {}; }
+    virtual EJSON on_double(double) { return {}; }
+    virtual EJSON on_string(std::string_view const &) { return {}; }
+    virtual EJSON on_key(std::string_view const &) { return {}; }
+    virtual EJSON on_begin_object() { return {}; }
+    virtual EJSON on_end_object() { return {}; }
+    virtual EJSON on_begin_array() { return {}; }
+    virtual EJSON on_end_array() { return {}; }
+};
+
+// Besides driving a JSONHandler, the reader can be used as a pull parser:
+// read_object() and read_array() call back for every member resp. element,
+// and the callback consumes the value with one of the read_ methods,
+// read_json(), or skip().
+class JSONReader {
+public:
+    static constexpr int MaxDepth = 512;
+
+    explicit JSONReader(std::string_view const &text)
+        : m_text(text)
+    {
+    }
+
+    EJSON read(JSONHandler &handler);
+    EJSON read_next(JSONHandler &handler);
+    EJSON skip();
+    EJSON expect_end();
+    bool  accept_null();
+
+    Result<std::string_view, JSONError> read_string();
+    Result<int64_t, JSONError>          read_integer();
+    Result<double, JSONError>           read_double();
+    Result<bool, JSONError>             read_boolean();
+
+    [[nodiscard]] size_t position() const { return m_index; }
+    void                 rewind(size_t position) { m_index = position; }
+
+    template<typename OnMember>
+    EJSON read_object(OnMember const &on_member)
+    {
+        skip_whitespace();
+        if (!accept('{')) {
+            return error("Expected '{'");
+        }
+        skip_whitespace();
+        if (accept('}')) {
+            return {};
+        }
+        while (true) {
+            auto key = TRY_EVAL(read_string());
+            skip_whitespace();
+            if (!accept(':')) {
+                return error("Expected ':'");
+            }
+            TRY(on_member(key));
+            skip_whitespace();
+            if (accept(',')) {
+                continue;
+            }
+            if (accept('}')) {
+                return {};
+            }
+            return error("Expected ',' or '}'");
+        }
+    }
+
+    template<typename OnElement>
+    EJSON read_array(OnElement const &on_element)
+    {
+        skip_whitespace();
+        if (!accept('[')) {
+            return error("Expected '['");
+        }
+        skip_whitespace();
+        if (accept(']')) {
+            return {};
+        }
+        while (true) {
+            TRY(on_element());
+            skip_whitespace();
+            if (accept(',')) {
+                continue;
+            }
+            if (accept(']')) {
+                return {};
+            }
+            return error("Expected ',' or ']'");
+        }
+    }
+
+    // Fast path for large arrays of integers, like semantic token data:
+    // digits are accumulated in place without going through the handler
+    // or std::from_chars.
+    template<Integer Int>
+    EJSON read_integer_array(std::vector<Int> &values)
+    {
+        skip_whitespace();
+        if (!accept('[')) {
+            return error("Expected '['");
+        }
+        skip_whitespace();
+        if (accept(']')) {
+            return {};
+        }
+        while (true) {
+            skip_whitespace();
+            auto    start = m_index;
+            auto    negative = accept('-');
+            auto    digits = m_index;
+            int64_t value = 0;
+            while (is_digit() && m_index - digits < 18) {
+                value = value * 10 + (m_text[m_index++] - '0');
+            }
+            if (m_index == digits || is_digit() || (m_index < m_text.length() && (m_text[m_index] == '.' || m_text[m_index] == 'e' || m_text[m_index] == 'E'))) {
+                m_index = start;
+                value = TRY_EVAL(read_integer());
+            } else if (negative) {
+                value = -value;
+            }
+            if (value < min_value<Int>() || (value > 0 && static_cast<uint64_t>(value) > max_value<Int>())) {
+                return error("Integer out of range", start);
+            }
+            values.push_back(static_cast<Int>(value));
+            skip_whitespace();
+            if (accept(',')) {
+                continue;
+            }
+            if (accept(']')) {
+                return {};
+            }
+            return error("Expected ',' or ']'");
+        }
+    }
+
+    [[nodiscard]] JSONError error(JSONError::Code code, std::string_view const &msg, size_t at) const;
+    [[nodiscard]] JSONError error(std::string_view const &msg, size_t at) const { return error(JSONError::Code::SyntaxError, msg, at); }
+    [[nodiscard]] JSONError error(std::string_view const &msg) const { return error(msg, m_index); }
+
+private:
+    struct Number {
+        bool    is_double { false };
+        int64_t integer { 0 };
+        double  dbl { 0.0 };
+    };
+
+    EJSON                               parse_value(JSONHandler &handler, int depth);
+    EJSON                               parse_object(JSONHandler &handler, int depth);
+    EJSON                               parse_array(JSONHandler &handler, int depth);
+    EJSON                               skip_value(int depth);
+    Result<Number, JSONError>           scan_number();
+    Result<std::string_view, JSONError> scan_string();
+    EJSON                               skip_string();
+    EJSON                               read_literal(std::string_view const &literal);
+    EJSON                               read_escape();
+    Result<uint32_t, JSONError>         read_hex4();
+    void                                skip_whitespace();
+    bool                                accept(char ch);
+
+    [[nodiscard]] bool is_digit() const
+    {
+        return m_index < m_text.length() && m_text[m_index] >= '0' && m_text[m_index] <= '9';
+    }
+
+    std::string_view m_text;
+    size_t           m_index { 0 };
+    std::string      m_scratch {};
+};
+
+class JSONBuilder : public JSONHandler {
+public:
+    EJSON on_null() override { return add(JSONValue {}); }
+    EJSON on_boolean(bool value) override { return add(JSONValue { value }); }
+    EJSON on_integer(int64_t value) override { return add(JSONValue { value }); }
+    EJSON on_double(double value) override { return add(JSONValue { value }); }
+    EJSON on_string(std::string_view const &value) override { return add(JSONValue { value }); }
+    EJSON on_key(std::string_view const &key) override;
+    EJSON on_begin_object() override;
+    EJSON on_end_object() override;
+    EJSON on_begin_array() override;
+    EJSON on_end_array() override;
+
+    JSONValue &result() { return m_result; }
+
+private:
+    EJSON add(JSONValue value);
+
+    std::vector<JSONValue>   m_stack {};
+    std::vector<std::string> m_keys {};
+    JSONValue                m_result {};
+};
+
+template<typename T>
+EJSON read_json(JSONReader &reader, T &value)
+{
+    return T::read(reader, value);
+}
+
+template<Integer Int>
+EJSON read_json(JSONReader &reader, Int &value)
+{
+    auto v = TRY_EVAL(reader.read_integer());
+    if (v < min_value<Int>() || (v > 0 && static_cast<uint64_t>(v) > max_value<Int>())) {
+        return JSONError { JSONError::Code::TypeMismatch, std::format("Value {} out of range for {}", v, typeid(Int).name()) };
+    }
+    value = static_cast<Int>(v);
+    return {};
+}
+
+template<Boolean B>
+EJSON read_json(JSONReader &reader, B &value)
+{
+    value = TRY_EVAL(reader.read_boolean());
+    return {};
+}
+
+template<std::floating_point Float>
+EJSON read_json(JSONReader &reader, Float &value)
+{
+    value = static_cast<Float>(TRY_EVAL(reader.read_double()));
+    return {};
+}
+
+inline EJSON read_json(JSONReader &reader, std::string &value)
+{
+    value = TRY_EVAL(reader.read_string());
+    return {};
+}
+
+inline EJSON read_json(JSONReader &reader, JSONValue &value)
+{
+    JSONBuilder builder;
+    TRY(reader.read_next(builder));
+    value = std::move(builder.result());
+    return {};
+}
+
+template<typename T>
+EJSON read_json(JSONReader &reader, std::optional<T> &value)
+{
+    if (reader.accept_null()) {
+        value.reset();
+        return {};
+    }
+    value.emplace();
+    return read_json(reader, *value);
+}
+
+template<typename T>
+EJSON read_json(JSONReader &reader, std::vector<T> &values)
+{
+    return reader.read_array([&reader, &values]() -> EJSON {
+        TRY(read_json(reader, values.emplace_back()));
+        return {};
+    });
+}
+
+template<Integer Int>
+EJSON read_json(JSONReader &reader, std::vector<Int> &values)
+{
+    return reader.read_integer_array(values);
+}
+
+template<size_t N, typename... Ts>
+EJSON read_json_variant(JSONReader &reader, std::variant<Ts...> &value)
+{
+    auto                                                position = reader.position();
+    std::variant_alternative_t<N, std::variant<Ts...>> alternative {};
+    auto                                                err = read_json(reader, alternative);
+    if (!err.is_error()) {
+        value.template emplace<N>(std::move(alternative));
+        return {};
+    }
+    reader.rewind(position);
+    if constexpr (N > 0) {
+        return read_json_variant<N - 1, Ts...>(reader, value);
+    } else {
+        return err;
+    }
+}
+
+// Alternatives are tried back to front, like JSONValue::convert does.
+template<typename... Ts>
+EJSON read_json(JSONReader &reader, std::variant<Ts...> &value)
+{
+    return read_json_variant<sizeof...(Ts) - 1, Ts...>(reader, value);
+}
+
+template<typename T>
+Decoded<T> decode(JSONReader &reader)
+{
+    T ret {};
+    TRY(read_json(reader, ret));
+    return ret;
+}
+
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstring>
+
+#include <LibCore/JSONTape.h>
+
+namespace LibCore {
+
+using namespace std::literals;
+
+/*
+ * ---------------------------------------------------------------------------
+ * -- JSONTape
+ * ---------------------------------------------------------------------------
+ */
+
+enum class Expect {
+    Value,
+    ValueOrClose,
+    Key,
+    KeyOrClose,
+    Colon,
+    CommaOrClose,
+    End,
+};
+
+static bool is_number_char(char ch)
+{
+    return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+EJSON JSONTape::index(std::string_view const &text)
+{
+    clear();
+    m_text = text;
+    auto error = [this](std::string_view const &msg, size_t at) {
+        return JSONReader { m_text }.error(msg, at);
+    };
+
+    auto   expect = Expect::Value;
+    size_t ix = 0;
+    while (true) {
+        while (ix < m_text.length() && (m_text[ix] == ' ' || m_text[ix] == '\t' || m_text[ix] == '\r' || m_text[ix] == '\n')) {
+            ++ix;
+        }
+        if (ix >= m_text.length()) {
+            break;
+        }
+        auto ch = m_text[ix];
+        switch (expect) {
+        case Expect::End:
+            return error("Unexpected characters after JSON value", ix);
+        case Expect::Colon:
+            if (ch != ':') {
+                return error("Expected ':'", ix);
+            }
+            ++ix;
+            expect = Expect::Value;
+            continue;
+        case Expect::CommaOrClose:
+            if (ch == ',') {
+                ++ix;
+                expect = (m_entries[m_open.back()].kind == Kind::Object) ? Expect::Key : Expect::Value;
+                continue;
+            }
+            TRY(close(ix++, ch));
+            expect = m_open.empty() ? Expect::End : Expect::CommaOrClose;
+            continue;
+        case Expect::KeyOrClose:
+        case Expect::ValueOrClose:
+            if (ch == '}' || ch == ']') {
+                TRY(close(ix++, ch));
+                expect = m_open.empty() ? Expect::End : Expect::CommaOrClose;
+                continue;
+            }
+            break;
+        default:
+            break;
+        }
+        if ((expect == Expect::Key || expect == Expect::KeyOrClose) && ch != '"') {
+            return error("Expected quoted string", ix);
+        }
+
+        auto  start = ix;
+        Entry entry { Kind::Null, static_cast<uint32_t>(start), 0, static_cast<uint32_t>(m_entries.size() + 1) };
+        switch (ch) {
+        case '{':
+        case '[':
+            if (m_open.size() >= JSONReader::MaxDepth) {
+                return error("Maximum nesting depth exceeded", ix);
+            }
+            entry.kind = (ch == '{') ? Kind::Object : Kind::Array;
+            m_open.push_back(static_cast<uint32_t>(m_entries.size()));
+            m_entries.push_back(entry);
+            ++ix;
+            expect = (ch == '{') ? Expect::KeyOrClose : Expect::ValueOrClose;
+            continue;
+        case '"':
+            entry.kind = Kind::String;
+            while (true) {
+                auto const *quote = static_cast<char const *>(memchr(m_text.data() + ix + 1, '"', m_text.length() - ix - 1));
+                if (quote == nullptr) {
+                    return error("Unterminated string", start);
+                }
+                ix = quote - m_text.data();
+                // The quote is escaped if it is preceded by an odd number of backslashes.
+                auto backslashes = 0u;
+                while (m_text[ix - backslashes - 1] == '\\') {
+                    ++backslashes;
+                }
+                if (backslashes % 2 == 0) {
+                    break;
+                }
+            }
+            ++ix;
+            break;
+        case 't':
+        case 'f':
+        case 'n': {
+            auto literal = (ch == 't') ? "true"sv : ((ch == 'f') ? "false"sv : "null"sv);
+            if (!m_text.substr(ix).starts_with(literal)) {
+                return error("Invalid literal", ix);
+            }
+            entry.kind = (ch == 't') ? Kind::True : ((ch == 'f') ? Kind::False : Kind::Null);
+            ix += literal.length();
+        } break;
+        default:
+            if (ch != '-' && (ch < '0' || ch > '9')) {
+                return error(std::format("Unexpected character '{:c}'", ch), ix);
+            }
+            entry.kind = Kind::Number;
+            while (ix < m_text.length() && is_number_char(m_text[ix])) {
+                ++ix;
+            }
+            break;
+        }
+        entry.length = static_cast<uint32_t>(ix - start);
+        m_entries.push_back(entry);
+        if (expect == Expect::Key || expect == Expect::KeyOrClose) {
+            expect = Expect::Colon;
+        } else {
+            expect = m_open.empty() ? Expect::End : Expect::CommaOrClose;
+        }
+    }
+    if (expect != Expect::End) {
+        return error("Unexpected end of input", m_text.length());
+    }
+    return {};
+}
+
+EJSON JSONTape::close(size_t at, char ch)
+{
+    if (m_open.empty()) {
+        return JSONReader { m_text }.error("Unexpected characters after JSON value", at);
+    }
+    auto &entry = m_entries[m_open.back()];
+    if ((entry.kind == Kind::Object && ch != '}') || (entry.kind == Kind::Array && ch != ']')) {
+        return JSONReader { m_text }.error((entry.kind == Kind::Object) ? "Expected ',' or '}'" : "Expected ',' or ']'", at);
+    }
+    entry.length = static_cast<uint32_t>(at + 1 - entry.offset);
+    entry.next = static_cast<uint32_t>(m_entries.size());
+    m_open.pop_back();
+    return {};
+}
+
+void JSONTape::clear()
+{
+    m_text = {};
+    m_entries.clear();
+    m_open.clear();
+}
+
+JSONTape::Ref JSONTape::root() const
+{
+    assert(!m_entries.empty());
+    return Ref { this, 0 };
+}
+
+/*
+ * ---------------------------------------------------------------------------
+ * -- JSONTape::Ref
+ * ---------------------------------------------------------------------------
+ */
+
+JSONType JSONTape::Ref::type() const
+{
+    switch (entry().kind) {
+    case Kind::Null:
+        return JSONType::Null;
+    case Kind::True:
+    case Kind::False:
+        return JSONType::Boolean;
+    case Kind::Number:
+        return (text().find_first_of(".eE") != std::string_view::npos) ? JSONType::Double : JSONType::Integer;
+    case Kind::String:
+        return JSONType::String;
+    case Kind::Array:
+        return JSONType::Array;
+    case Kind::Object:
+        return JSONType::Object;
+    }
+    UNREACHABLE();
+}
+
+std::string_view JSONTape::Ref::text() const
+{
+    auto const &e = entry();
+    return m_tape->m_text.substr(e.offset, e.length);
+}
+
+size_t JSONTape::Ref::size() const
+{
+    auto const &e = entry();
+    if (e.kind != Kind::Array && e.kind != Kind::Object) {
+        return 0;
+    }
+    size_t ret = 0;
+    for (auto ix = m_ix + 1; ix < e.next; ix = m_tape->m_entries[ix].next) {
+        ++ret;
+    }
+    return (e.kind == Kind::Object) ? ret / 2 : ret;
+}
+
+bool JSONTape::Ref::key_equals(uint32_t key_ix, std::string_view const &key) const
+{
+    auto const &k = m_tape->m_entries[key_ix];
+    auto        raw = m_tape->m_text.substr(k.offset + 1, k.length - 2);
+    if (raw.find('\\') == std::string_view::npos) {
+        return raw == key;
+    }
+    auto unescaped = Ref { m_tape, key_ix }.as_string();
+    return unescaped.has_value() && unescaped.value() == key;
+}
+
+std::optional<JSONTape::Ref> JSONTape::Ref::get(std::string_view const &key) const
+{
+    auto const &e = entry();
+    if (e.kind != Kind::Object) {
+        return {};
+    }
+    // Duplicate keys resolve like JSONValue::set, i.e. the last one wins.
+    std::optional<Ref> ret;
+    for (auto ix = m_ix + 1; ix < e.next; ix = m_tape->m_entries[ix + 1].next) {
+        if (key_equals(ix, key)) {
+            ret = Ref { m_tape, ix + 1 };
+        }
+    }
+    return ret;
+}
+
+std::optional<JSONTape::Ref> JSONTape::Ref::get(size_t ix) const
+{
+    auto const &e = entry();
+    if (e.kind != Kind::Array) {
+        return {};
+    }
+    for (auto elem = m_ix + 1; elem < e.next; elem = m_tape->m_entries[elem].next) {
+        if (ix-- == 0) {
+            return Ref { m_tape, elem };
+        }
+    }
+    return {};
+}
+
+// get(ix) walks the array from the start. Use this to visit all elements
+// in a single pass.
+std::vector<JSONTape::Ref> JSONTape::Ref::elements() const
+{
+    std::vector<Ref> ret;
+    auto const      &e = entry();
+    if (e.kind != Kind::Array) {
+        return ret;
+    }
+    for (auto elem = m_ix + 1; elem < e.next; elem = m_tape->m_entries[elem].next) {
+        ret.push_back(Ref { m_tape, elem });
+    }
+    return ret;
+}
+
+Decoded<std::string> JSONTape::Ref::as_string() const
+{
+    JSONReader reader { text() };
+    return std::string { TRY_EVAL(reader.read_string()) };
+}
+
+Decoded<int64_t> JSONTape::Ref::as_integer() const
+{
+    JSONReader reader { text() };
+    return reader.read_integer();
+}
+
+Decoded<JSONValue> JSONTape::Ref::to_value() const
+{
+    return JSONValue::deserialize(text());
+}
+
+}
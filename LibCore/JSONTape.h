@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include <LibCore/JSON.h>
+#include <LibCore/JSONReader.h>
+
+namespace LibCore {
+
+// Structural index over a JSON text. index() makes a single pass that
+// records where every value starts and ends, without unescaping strings or
+// converting numbers. Values are only decoded when they are accessed, so
+// looking up a few members of a large message is cheap.
+//
+// The tape refers to the indexed text, which has to outlive it.
+class JSONTape {
+public:
+    class Ref;
+
+    EJSON                          index(std::string_view const &text);
+    void                           clear();
+    [[nodiscard]] Ref              root() const;
+    [[nodiscard]] std::string_view text() const { return m_text; }
+    [[nodiscard]] size_t           size() const { return m_entries.size(); }
+
+private:
+    enum class Kind : uint8_t {
+        Null,
+        True,
+        False,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+    // Containers are followed by their children; object members are a key
+    // entry followed by the value. next is the tape index just past the
+    // entry's subtree, which makes skipping a sibling O(1).
+    struct Entry {
+        Kind     kind;
+        uint32_t offset;
+        uint32_t length;
+        uint32_t next;
+    };
+
+    EJSON close(size_t at, char ch);
+
+    std::string_view      m_text;
+    std::vector<Entry>    m_entries {};
+    std::vector<uint32_t> m_open {};
+};
+
+class JSONTape::Ref {
+public:
+    [[nodiscard]] JSONType         type() const;
+    [[nodiscard]] bool             is_null() const { return entry().kind == Kind::Null; }
+    [[nodiscard]] bool             is_string() const { return entry().kind == Kind::String; }
+    [[nodiscard]] bool             is_number() const { return entry().kind == Kind::Number; }
+    [[nodiscard]] bool             is_array() const { return entry().kind == Kind::Array; }
+    [[nodiscard]] bool             is_object() const { return entry().kind == Kind::Object; }
+    [[nodiscard]] std::string_view text() const;
+
+    [[nodiscard]] size_t             size() const;
+    [[nodiscard]] std::optional<Ref> get(std::string_view const &key) const;
+    [[nodiscard]] bool               has(std::string_view const &key) const { return get(key).has_value(); }
+    [[nodiscard]] std::optional<Ref> get(size_t ix) const;
+    [[nodiscard]] std::vector<Ref>   elements() const;
+
+    [[nodiscard]] Decoded<std::string> as_string() const;
+    [[nodiscard]] Decoded<int64_t>     as_integer() const;
+    [[nodiscard]] Decoded<JSONValue>   to_value() const;
+
+    template<typename T>
+    [[nodiscard]] Decoded<T> decode() const
+    {
+        JSONReader reader { text() };
+        auto       ret = TRY_EVAL(::LibCore::decode<T>(reader));
+        TRY(reader.expect_end());
+        return ret;
+    }
+
+private:
+    friend class JSONTape;
+
+    Ref(JSONTape const *tape, uint32_t ix)
+        : m_tape(tape)
+        , m_ix(ix)
+    {
+    }
+
+    [[nodiscard]] Entry const &entry() const { return m_tape->m_entries[m_ix]; }
+    [[nodiscard]] bool         key_equals(uint32_t key_ix, std::string_view const &key) const;
+
+    JSONTape const *m_tape;
+    uint32_t        m_ix;
+};
+
+}
@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <unistd.h>
+
+#include <LibCore/JSONWriter.h>
+
+namespace LibCore {
+
+static constexpr std::array<char, 128> s_escapes = []() {
+    std::array<char, 128> ret {};
+    for (auto ch = 0; ch < 0x20; ++ch) {
+        ret[ch] = 'u';
+    }
+    ret['\b'] = 'b';
+    ret['\f'] = 'f';
+    ret['\n'] = 'n';
+    ret['\r'] = 'r';
+    ret['\t'] = 't';
+    ret['"'] = '"';
+    ret['\\'] = '\\';
+    return ret;
+}();
+
+static bool needs_escape(char ch)
+{
+    auto uch = static_cast<unsigned char>(ch);
+    return uch < 128 && s_escapes[uch] != 0;
+}
+
+void JSONWriter::write_string(std::string_view const &s)
+{
+    m_out += '"';
+    auto const *p = s.data();
+    auto const *end = p + s.length();
+    while (p < end) {
+        auto const *run = p;
+        while (p < end && !needs_escape(*p)) {
+            ++p;
+        }
+        m_out.append(run, p);
+        if (p == end) {
+            break;
+        }
+        auto escape = s_escapes[static_cast<unsigned char>(*p)];
+        m_out += '\\';
+        m_out += escape;
+        if (escape == 'u') {
+            static constexpr char hex[] = "0123456789abcdef";
+            m_out += "00";
+            m_out += hex[(*p >> 4) & 0x0F];
+            m_out += hex[*p & 0x0F];
+        }
+        ++p;
+    }
+    m_out += '"';
+}
+
+void JSONWriter::newline()
+{
+    if (m_pretty) {
+        m_out += '\n';
+        m_out.append(m_indent + m_first.size() * m_indent_width, ' ');
+    }
+}
+
+void JSONWriter::before_value()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (m_first.empty()) {
+        return;
+    }
+    if (!m_first.back()) {
+        m_out += ',';
+    }
+    m_first.back() = false;
+    newline();
+}
+
+void JSONWriter::check_flush()
+{
+    if (m_fd >= 0 && m_out.length() >= FlushThreshold) {
+        IGNORE(flush());
+    }
+}
+
+CError JSONWriter::flush()
+{
+    if (m_fd < 0) {
+        return {};
+    }
+    size_t total = 0;
+    while (total < m_out.length()) {
+        auto count = ::write(m_fd, m_out.data() + total, m_out.length() - total);
+        if (count < 0) {
+            if (errno != EINTR) {
+                m_out.clear();
+                return LibCError();
+            }
+            continue;
+        }
+        total += count;
+    }
+    m_out.clear();
+    return {};
+}
+
+JSONWriter &JSONWriter::begin_object()
+{
+    before_value();
+    m_out += '{';
+    m_first.push_back(true);
+    return *this;
+}
+
+JSONWriter &JSONWriter::end_object()
+{
+    assert(!m_first.empty() && !m_after_key);
+    auto empty = m_first.back();
+    m_first.pop_back();
+    if (!empty) {
+        newline();
+    }
+    m_out += '}';
+    check_flush();
+    return *this;
+}
+
+JSONWriter &JSONWriter::begin_array()
+{
+    before_value();
+    m_out += '[';
+    m_first.push_back(true);
+    return *this;
+}
+
+JSONWriter &JSONWriter::end_array()
+{
+    assert(!m_first.empty());
+    auto empty = m_first.back();
+    m_first.pop_back();
+    if (!empty) {
+        newline();
+    }
+    m_out += ']';
+    check_flush();
+    return *this;
+}
+
+JSONWriter &JSONWriter::key(std::string_view const &key)
+{
+    before_value();
+    write_string(key);
+    m_out += m_pretty ? ": " : ":";
+    m_after_key = true;
+    return *this;
+}
+
+JSONWriter &JSONWriter::null()
+{
+    before_value();
+    m_out += "null";
+    return *this;
+}
+
+JSONWriter &JSONWriter::value(bool b)
+{
+    before_value();
+    m_out += b ? "true" : "false";
+    return *this;
+}
+
+JSONWriter &JSONWriter::value(int64_t i)
+{
+    before_value();
+    char buffer[24];
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), i);
+    m_out.append(buffer, ptr);
+    return *this;
+}
+
+JSONWriter &JSONWriter::value(double d)
+{
+    if (!std::isfinite(d)) {
+        return null();
+    }
+    before_value();
+    char buffer[32];
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), d);
+    std::string_view str { buffer, ptr };
+    m_out += str;
+    // Keep the value a double when it is read back.
+    if (str.find_first_of(".e") == std::string_view::npos) {
+        m_out += ".0";
+    }
+    return *this;
+}
+
+JSONWriter &JSONWriter::value(std::string_view const &s)
+{
+    before_value();
+    write_string(s);
+    check_flush();
+    return *this;
+}
+
+JSONWriter &JSONWriter::write(JSONValue const &value)
+{
+    switch (value.type()) {
+    case JSONType::Null:
+        return null();
+    case JSONType::Boolean:
+        return this->value(std::get<bool>(value.raw_value()));
+    case JSONType::Integer:
+        return this->value(std::get<int64_t>(value.raw_value()));
+    case JSONType::Double:
+        return this->value(std::get<double>(value.raw_value()));
+    case JSONType::String:
+        return this->value(std::string_view { std::get<std::string>(value.raw_value()) });
+    case JSONType::Array:
+        begin_array();
+        for (auto const &elem : std::get<JSONValue::Array>(value.raw_value())) {
+            write(elem);
+        }
+        return end_array();
+    case JSONType::Object:
+        begin_object();
+        for (auto const &[name, member] : std::get<JSONValue::Object>(value.raw_value())) {
+            key(name);
+            write(member);
+        }
+        return end_object();
+    }
+    UNREACHABLE();
+}
+
+}
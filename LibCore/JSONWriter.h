@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LibCore/Error.h>
+#include <LibCore/JSON.h>
+
+namespace LibCore {
+
+// Appends JSON text to a caller-owned buffer, or to an internal buffer that
+// is flushed to a file descriptor. Commas, colons and (in pretty mode)
+// newlines and indentation are inserted automatically.
+class JSONWriter {
+public:
+    static constexpr size_t FlushThreshold = 64 * 1024;
+
+    explicit JSONWriter(std::string &out, bool pretty = false, int indent_width = 4, int indent = 0)
+        : m_out(out)
+        , m_pretty(pretty)
+        , m_indent_width(indent_width)
+        , m_indent(indent)
+    {
+    }
+
+    explicit JSONWriter(int fd, bool pretty = false, int indent_width = 4)
+        : m_out(m_own)
+        , m_fd(fd)
+        , m_pretty(pretty)
+        , m_indent_width(indent_width)
+    {
+    }
+
+    JSONWriter(JSONWriter const &) = delete;
+    JSONWriter &operator=(JSONWriter const &) = delete;
+
+    ~JSONWriter()
+    {
+        IGNORE(flush());
+    }
+
+    JSONWriter &write(JSONValue const &value);
+    JSONWriter &begin_object();
+    JSONWriter &end_object();
+    JSONWriter &begin_array();
+    JSONWriter &end_array();
+    JSONWriter &key(std::string_view const &key);
+    JSONWriter &null();
+    JSONWriter &value(bool b);
+    JSONWriter &value(int64_t i);
+    JSONWriter &value(double d);
+    JSONWriter &value(std::string_view const &s);
+
+    JSONWriter &value(char const *s)
+    {
+        return value(std::string_view { s });
+    }
+
+    template<Integer Int>
+    JSONWriter &value(Int i)
+    {
+        return value(static_cast<int64_t>(i));
+    }
+
+    CError flush();
+
+private:
+    void before_value();
+    void newline();
+    void write_string(std::string_view const &s);
+    void check_flush();
+
+    std::string       m_own {};
+    std::string      &m_out;
+    int               m_fd { -1 };
+    bool              m_pretty { false };
+    int               m_indent_width { 4 };
+    int               m_indent { 0 };
+    std::vector<bool> m_first {};
+    bool              m_after_key { false };
+};
+
+}
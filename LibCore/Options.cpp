@@ -22,6 +22,7 @@ void set_option(std::string_view option, std::string_view value)
 
 int parse_options(int argc, char const **argv)
 {
+    s_options.clear();
     auto ix = 1;
     while (ix < argc && strlen(argv[ix]) > 2 && strncmp(argv[ix], "--", 2) == 0) {
         std::string_view option = argv[ix] + 2;
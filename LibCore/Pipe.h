@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <string>
@@ -129,6 +130,13 @@ public:
         return m_context;
     }
 
+    // Once this is true the reading thread has let go of the pipe, and it
+    // can be destroyed.
+    bool finished() const
+    {
+        return m_finished;
+    }
+
 private:
     void read()
     {
@@ -151,6 +159,7 @@ private:
             }
         }
         close();
+        m_finished = true;
     }
 
     constexpr static int DRAIN_SIZE = (64 * 1024);
@@ -196,6 +205,7 @@ private:
     std::optional<OnRead>   m_on_read {};
     T                       m_context {};
     bool                    m_debug { false };
+    std::atomic<bool>       m_finished { false };
 };
 
 class WritePipe {
@@ -238,6 +248,11 @@ public:
         ::close(m_pipe[PipeEndWrite]);
     }
 
+    [[nodiscard]] int fd() const
+    {
+        return m_fd;
+    }
+
     Result<size_t> write(std::string_view sv) const
     {
         return write_chars(sv.data(), sv.length());
@@ -260,8 +275,8 @@ public:
     }
 
 private:
-    int m_pipe[2];
-    int m_fd;
+    int m_pipe[2] { 0, 0 };
+    int m_fd { -1 };
 };
 
 }
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <concepts>
 #include <print>
 #include <sys/wait.h>
 
@@ -31,6 +32,7 @@ public:
     }
 
     template<typename... Args>
+        requires(std::convertible_to<Args, std::string_view> && ...)
     Process(std::string_view const &cmd, Args &&...args)
         : Process(cmd)
     {
@@ -38,11 +40,18 @@ public:
         set_arguments(cmd_args, std::forward<Args>(args)...);
     }
 
+    Process(std::string_view const &cmd, StringList const &args)
+        : Process(cmd)
+    {
+        set_arguments(args);
+    }
+
     ~Process()
     {
     }
 
     pid_t pid() const { return m_pid; }
+    bool  finished() const { return m_out.finished() && m_err.finished(); }
 
     Process &on_stdout_read(OnRead const &on_read)
     {
@@ -154,6 +163,11 @@ public:
         return {};
     }
 
+    [[nodiscard]] int stdin_fd() const
+    {
+        return m_in.fd();
+    }
+
     std::string stdout_file;
     std::string stderr_file;
 
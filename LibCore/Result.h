@@ -22,10 +22,10 @@ public:
     {
     }
 
-    //    Result(ResultType &&return_value)
-    //        : m_value(std::move(return_value))
-    //    {
-    //    }
+    Result(ResultType &&return_value)
+        : m_value(std::move(return_value))
+    {
+    }
 
     template<typename U>
     Result(U &&value)
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2024, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+#include <LibCore/Logging.h>
+
+namespace LibCore {
+
+// Lazily started coroutine. A Task runs when it is co_awaited, in which
+// case the awaiting coroutine is resumed with its result when it finishes,
+// or when it is detached, in which case it runs on its own and cleans up
+// after itself.
+template<typename T = void>
+class Task;
+
+namespace Detail {
+
+template<typename Promise>
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+    {
+        auto &promise = handle.promise();
+        if (promise.continuation) {
+            return promise.continuation;
+        }
+        if (promise.detached) {
+            handle.destroy();
+        }
+        return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation {};
+    bool                    detached { false };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    void                unhandled_exception() const noexcept { std::terminate(); }
+};
+
+}
+
+template<typename T>
+class Task {
+public:
+    struct promise_type : Detail::PromiseBase {
+        std::optional<T> value {};
+
+        Task                               get_return_object() { return Task { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        Detail::FinalAwaiter<promise_type> final_suspend() const noexcept { return {}; }
+        void                               return_value(T v) { value.emplace(std::move(v)); }
+    };
+
+    Task(Task &&other) noexcept
+        : m_handle(std::exchange(other.m_handle, {}))
+    {
+    }
+
+    Task(Task const &) = delete;
+
+    ~Task()
+    {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+
+    T await_resume()
+    {
+        assert(m_handle.promise().value.has_value());
+        return std::move(*m_handle.promise().value);
+    }
+
+    void detach()
+    {
+        auto handle = std::exchange(m_handle, {});
+        handle.promise().detached = true;
+        handle.resume();
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+template<>
+class Task<void> {
+public:
+    struct promise_type : Detail::PromiseBase {
+        Task                               get_return_object() { return Task { std::coroutine_handle<promise_type>::from_promise(*this) }; }
+        Detail::FinalAwaiter<promise_type> final_suspend() const noexcept { return {}; }
+        void                               return_void() const noexcept { }
+    };
+
+    Task(Task &&other) noexcept
+        : m_handle(std::exchange(other.m_handle, {}))
+    {
+    }
+
+    Task(Task const &) = delete;
+
+    ~Task()
+    {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+
+    void await_resume() const noexcept
+    {
+    }
+
+    void detach()
+    {
+        auto handle = std::exchange(m_handle, {});
+        handle.promise().detached = true;
+        handle.resume();
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+}
@@ -5,9 +5,11 @@
  */
 
 #include <iostream>
+#include <unistd.h>
 
 #include <LibCore/IO.h>
 #include <LibCore/JSON.h>
+#include <LibCore/JSONWriter.h>
 #include <LibCore/Options.h>
 
 using namespace LibCore;
@@ -32,7 +34,12 @@ int main(int argc, char const **argv)
         std::cerr << "JSON parse error: " << json_maybe.error().to_string() << std::endl;
         return 1;
     }
-    auto res = json_maybe.value().serialize(true);
-    std::cout << res << std::endl;
+    JSONWriter writer { STDOUT_FILENO, true };
+    writer.write(json_maybe.value());
+    if (auto err = writer.flush(); err.is_error()) {
+        std::cerr << err.error().to_string() << std::endl;
+        return 1;
+    }
+    std::cout << std::endl;
     return 0;
 }
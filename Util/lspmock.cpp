@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2025, Jan de Visser <jan@finiandarcy.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+// Stands in for a language server by replaying a recording made with the
+// "record" option of a server in settings.json. Messages the client sent
+// during the recording are waited for, and the server's messages are sent
+// with the same delays as in the recording, divided by --speed. --speed=0
+// sends them as soon as possible. Response ids are rewritten to the ids of
+// the live requests.
+
+#include <charconv>
+#include <iostream>
+#include <map>
+#include <sys/poll.h>
+#include <thread>
+#include <unistd.h>
+
+#include <LibCore/JSON.h>
+#include <LibCore/Options.h>
+#include <LSP/MessageFramer.h>
+#include <LSP/Recorder.h>
+
+using namespace LibCore;
+using namespace LSP;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto WaitTimeout = std::chrono::seconds { 10 };
+
+class Client {
+public:
+    // Returns the next message from the client, or an empty optional if
+    // none arrives before the timeout. Exits when the client closes stdin.
+    std::optional<std::string> next(std::chrono::milliseconds timeout)
+    {
+        auto deadline = Clock::now() + timeout;
+        while (true) {
+            auto message_maybe = m_framer.next();
+            if (message_maybe.is_error()) {
+                std::cerr << "lspmock: " << message_maybe.error().description << std::endl;
+                exit(1);
+            }
+            if (message_maybe.value()) {
+                return std::string { *message_maybe.value() };
+            }
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+            if (remaining.count() <= 0) {
+                return {};
+            }
+            pollfd poll_fd { STDIN_FILENO, POLLIN, 0 };
+            if (::poll(&poll_fd, 1, static_cast<int>(remaining.count())) <= 0) {
+                continue;
+            }
+            char buffer[64 * 1024];
+            auto count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                exit(0);
+            }
+            m_framer.feed(std::string_view { buffer, static_cast<size_t>(count) });
+        }
+    }
+
+private:
+    MessageFramer m_framer;
+};
+
+static void send(std::string_view const &body)
+{
+    auto message = std::format("Content-Length: {}\r\n\r\n{}", body.length(), body);
+    for (size_t written = 0; written < message.length();) {
+        auto count = ::write(STDOUT_FILENO, message.data() + written, message.length() - written);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            exit(1);
+        }
+        written += count;
+    }
+}
+
+int main(int argc, char const **argv)
+{
+    auto app_args = LibCore::parse_options(argc, argv);
+    if (app_args >= argc) {
+        std::cerr << "Usage: lspmock [--speed=<factor>] <recording>" << std::endl;
+        return 1;
+    }
+    double speed = 1.0;
+    if (auto speed_option = get_option("speed"); speed_option) {
+        auto [ptr, ec] = std::from_chars(speed_option->data(), speed_option->data() + speed_option->length(), speed);
+        if (ec != std::errc {} || speed < 0) {
+            std::cerr << "lspmock: Invalid speed '" << *speed_option << "'" << std::endl;
+            return 1;
+        }
+    }
+    auto recording_maybe = read_recording(argv[app_args]);
+    if (recording_maybe.is_error()) {
+        std::cerr << "lspmock: " << recording_maybe.error().to_string() << std::endl;
+        return 1;
+    }
+
+    Client                    client;
+    std::map<int, int>        live_ids;
+    std::chrono::microseconds last_time { 0 };
+    auto                      last_wall = Clock::now();
+    for (auto const &message : recording_maybe.value()) {
+        auto json_maybe = JSONValue::deserialize(message.body);
+        if (json_maybe.is_error()) {
+            std::cerr << "lspmock: " << json_maybe.error().to_string() << std::endl;
+            continue;
+        }
+        auto json = json_maybe.value();
+        auto method = json.try_get<std::string>("method");
+        auto id = json.try_get<int>("id");
+
+        if (message.direction == Direction::ClientToServer) {
+            // Responses to requests from the server and cancellations depend
+            // on timing, and are not waited for.
+            if (method.is_error() || method.value().starts_with("$/")) {
+                continue;
+            }
+            bool matched = false;
+            while (auto live = client.next(WaitTimeout)) {
+                auto live_json = JSONValue::deserialize(*live);
+                if (live_json.is_error()) {
+                    continue;
+                }
+                if (auto live_method = live_json.value().try_get<std::string>("method"); live_method.is_error() || live_method.value() != method.value()) {
+                    continue;
+                }
+                if (auto live_id = live_json.value().try_get<int>("id"); id.has_value() && live_id.has_value()) {
+                    live_ids[id.value()] = live_id.value();
+                }
+                matched = true;
+                break;
+            }
+            if (!matched) {
+                std::cerr << "lspmock: Timed out waiting for '" << method.value() << "'" << std::endl;
+            }
+            last_time = message.time;
+            last_wall = Clock::now();
+            if (method.value() == "exit") {
+                return 0;
+            }
+            continue;
+        }
+
+        if (speed > 0) {
+            auto delay = std::chrono::duration_cast<Clock::duration>((message.time - last_time) / speed);
+            std::this_thread::sleep_until(last_wall + delay);
+        }
+        last_time = message.time;
+        last_wall = Clock::now();
+        if (method.is_error() && id.has_value()) {
+            auto it = live_ids.find(id.value());
+            if (it == live_ids.end()) {
+                continue;
+            }
+            json.set("id", JSONValue { it->second });
+            send(json.serialize());
+            continue;
+        }
+        send(message.body);
+    }
+    return 0;
+}